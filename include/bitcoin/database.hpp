@@ -15,20 +15,29 @@
  */
 
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/checksum.hpp>
 #include <bitcoin/database/data_base.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/header_cache.hpp>
+#include <bitcoin/database/header_columns.hpp>
+#include <bitcoin/database/merkle_cache.hpp>
 #include <bitcoin/database/settings.hpp>
+#include <bitcoin/database/short_id.hpp>
+#include <bitcoin/database/short_id_map.hpp>
 #include <bitcoin/database/store.hpp>
 #include <bitcoin/database/unspent_outputs.hpp>
 #include <bitcoin/database/unspent_transaction.hpp>
 #include <bitcoin/database/version.hpp>
 #include <bitcoin/database/databases/address_database.hpp>
 #include <bitcoin/database/databases/block_database.hpp>
+#include <bitcoin/database/databases/spender_database.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
+#include <bitcoin/database/databases/undo_database.hpp>
 #include <bitcoin/database/memory/accessor.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/memory/storage.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/hash_table_header.hpp>
 #include <bitcoin/database/primitives/hash_table_multimap.hpp>
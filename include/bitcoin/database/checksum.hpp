@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_CHECKSUM_HPP
+#define LIBBITCOIN_DATABASE_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// Extend a CRC32C (Castagnoli) checksum with the given data.
+/// Uses the SSE4.2 crc32 instruction when the x86 processor supports it.
+BCD_API uint32_t crc32c(uint32_t crc, const uint8_t* data, size_t size);
+
+/// The CRC32C of the concatenated wire serialization (with witness) of the
+/// transactions. A zero result cannot be distinguished from no checksum.
+BCD_API uint32_t checksum(const chain::transaction::list& transactions);
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -20,15 +20,21 @@
 #define LIBBITCOIN_DATABASE_DATA_BASE_HPP
 
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/databases/address_database.hpp>
 #include <bitcoin/database/databases/block_database.hpp>
+#include <bitcoin/database/databases/spender_database.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
+#include <bitcoin/database/databases/undo_database.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/settings.hpp>
 #include <bitcoin/database/store.hpp>
@@ -71,15 +77,26 @@ public:
     /// Invalid if indexes not initialized.
     const address_database& addresses() const;
 
+    /// Invalid if spends not indexed.
+    const spender_database& spenders() const;
+
+    /// The height of the highest block of the block index for which address
+    /// rows are queryable, false if none or if addresses are not indexed.
+    bool indexed_height(size_t& out_height) const;
+
     // Node writers.
     // ------------------------------------------------------------------------
 
     /// Store unconfirmed tx that was verified with the given forks.
+    /// Concurrent calls are grouped into one write, commit and flush.
     code store(const chain::transaction& tx, uint32_t forks);
 
     /// Push next top header of expected height.
     code push(const chain::header& header, size_t height);
 
+    /// Push next top headers starting at expected height, in one write.
+    code push(header_const_ptr_list_const_ptr headers, size_t first_height);
+
     /// Pop top header of expected height.
     code pop(chain::header& out_header, size_t height);
 
@@ -104,6 +121,10 @@ public:
     /// Pop top block of expected height.
     code pop(chain::block& out_block, size_t height);
 
+    /// Index addresses of all blocks of the block index above the indexed
+    /// height in one bulk pass, ending deferral of address indexing.
+    code build_address_index();
+
 protected:
     void start();
     void commit();
@@ -116,22 +137,29 @@ protected:
     code verify_top(size_t height, bool block_index) const;
     code verify_push(const chain::transaction& tx) const;
     code verify_push(const chain::header& header, size_t height) const;
+    code verify_push(const message::header::const_ptr_list& headers,
+        size_t first_height) const;
     code verify_push(const chain::block& block, size_t height) const;
     code verify_update(const chain::block& block, size_t height) const;
 
     // Synchronous.
     // ------------------------------------------------------------------------
 
-    void push_inputs(const chain::transaction& tx);
-    void push_outputs(const chain::transaction& tx);
+    // Stored address rows are appended to out_rows (one list per bucket).
+    void push_inputs(const chain::transaction& tx, size_t height,
+        short_hash_list& out_rows);
+    void push_outputs(const chain::transaction& tx, size_t height,
+        short_hash_list& out_rows);
     code push_transactions(const chain::block& block, size_t height,
-        uint32_t median_time_past, size_t bucket=0, size_t buckets=1,
+        uint32_t median_time_past, short_hash_list& out_rows,
+        size_t bucket=0, size_t buckets=1,
         transaction_state state=transaction_state::confirmed);
+    code push_journal(const chain::block& block, size_t height,
+        const short_hash_list& rows);
 
-    bool pop_inputs(const chain::transaction& tx);
-    bool pop_outputs(const chain::transaction& tx);
     code pop_transactions(const chain::block& out_block, size_t bucket=0,
         size_t buckets=1);
+    code pop_journal(const block_result& result, size_t height);
 
     // Databases.
     // ------------------------------------------------------------------------
@@ -139,16 +167,67 @@ protected:
     std::shared_ptr<block_database> blocks_;
     std::shared_ptr<transaction_database> transactions_;
     std::shared_ptr<address_database> addresses_;
+    std::shared_ptr<spender_database> spenders_;
+    std::shared_ptr<undo_database> undos_;
 
 private:
     typedef chain::input::list inputs;
     typedef chain::output::list outputs;
 
+    struct address_row
+    {
+        short_hash key;
+        chain::payment_record payment;
+        uint64_t value;
+    };
+
+    typedef std::vector<address_row> address_rows;
+
+    // A pooled transaction store awaiting its group write.
+    struct pool_request
+    {
+        const chain::transaction& tx;
+        const uint32_t forks;
+        code result;
+        bool complete;
+    };
+
+    typedef std::vector<pool_request*> pool_requests;
+
+    // Group commit of pooled transactions.
+    void store_pooled(const pool_requests& requests);
+
+    void input_rows(address_rows& out_rows,
+        const chain::transaction& tx) const;
+    void output_rows(address_rows& out_rows,
+        const chain::transaction& tx) const;
+
+    bool index_inline() const;
+    bool index_async() const;
+    void store_rows(const address_rows& rows, size_t height);
+
+    // Asynchronous address indexing.
+    void start_indexer();
+    void stop_indexer();
+    void notify_indexer();
+    void do_index();
+    bool index_next();
+    void index_transactions(std::vector<address_rows>& out_rows,
+        const chain::transaction::list& txs, size_t height, size_t bucket,
+        size_t buckets) const;
+    code unindex(const chain::block& block, size_t height);
+
+    // Deferred bulk address indexing.
+    size_t extraction_threads() const;
+    code index_batch(size_t first, size_t last);
+    void extract_blocks(std::vector<std::vector<address_rows>>& out_rows,
+        size_t first, size_t bucket, size_t buckets) const;
+
     chain::transaction::list to_transactions(const block_result& result) const;
     code push_genesis(const chain::block& block);
-    bool pop_above(header_const_ptr_list_ptr headers,
+    code pop_above(header_const_ptr_list_ptr headers,
         const config::checkpoint& fork_point);
-    bool push_all(header_const_ptr_list_const_ptr headers,
+    code push_all(header_const_ptr_list_const_ptr headers,
         const config::checkpoint& fork_point);
 
     std::atomic<bool> closed_;
@@ -156,6 +235,25 @@ private:
 
     // Used to prevent concurrent unsafe writes.
     mutable shared_mutex write_mutex_;
+
+    // Group commit of pooled transactions.
+    pool_requests pool_queue_;
+    bool pool_leader_;
+    std::mutex pool_mutex_;
+    std::condition_variable pool_condition_;
+
+    // Asynchronous address indexing.
+    std::thread indexer_;
+    std::atomic<bool> indexer_stopped_;
+    bool indexer_pending_;
+    std::mutex indexer_mutex_;
+    std::condition_variable indexer_condition_;
+
+    // Used to prevent pop of a block while its rows are indexed.
+    mutable shared_mutex index_mutex_;
+
+    // Address indexing is deferred until build_address_index.
+    std::atomic<bool> deferred_;
 };
 
 } // namespace database
@@ -19,24 +19,105 @@
 #ifndef LIBBITCOIN_DATABASE_ADDRESS_DATABASE_HPP
 #define LIBBITCOIN_DATABASE_ADDRESS_DATABASE_HPP
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
-#include <bitcoin/database/primitives/hash_table_multimap.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
 #include <bitcoin/database/result/address_result.hpp>
 
 namespace libbitcoin {
 namespace database {
 
-/// This is a record multimap where the key is the Bitcoin address hash,
-/// which returns several rows giving the history for that address.
+/// This is a paged multimap where the key is the Bitcoin address hash, or
+/// a hash of a witness program and its type, which returns several rows
+/// giving the history for that address.
+/// The rows of an address are appended to contiguous pages of up to
+/// page_capacity rows, and the pages are linked newest first.
 class BCD_API address_database
 {
 public:
     typedef boost::filesystem::path path;
+    typedef std::vector<chain::payment_record> payment_list;
+
+    /// An opaque position within a history, for resuming a bounded query.
+    typedef uint64_t cursor;
+
+    /// The cursor of the first (newest) row of a history.
+    static const cursor first_cursor;
+
+    /// The cursor of a history query that has no more rows.
+    static const cursor last_cursor;
+
+    /// The maximum number of rows in a history page.
+    static const size_t page_capacity;
+
+    /// The type of address from which a history key is derived.
+    enum class address_type : uint8_t
+    {
+        /// A p2pkh or p2sh address, keyed by its hash.
+        payment_address,
+
+        /// A version zero witness program of a key hash (p2wpkh).
+        witness_key_hash,
+
+        /// A version zero witness program of a script hash (p2wsh).
+        witness_script_hash,
+
+        /// A version one witness program of a taproot output key (p2tr).
+        witness_taproot,
+
+        /// The sha256 hash of any output script, as keyed by electrum.
+        script_hash
+    };
+
+    /// The history key of a witness program, which commits to its type so
+    /// that witness keys cannot collide with payment address keys.
+    static short_hash to_key(address_type type, data_slice program);
+
+    /// The history key of the witness program of an output script, false if
+    /// the script is not a p2wpkh, p2wsh or p2tr output.
+    static bool to_key(short_hash& out_key, const chain::script& script);
+
+    /// The history key of the sha256 hash of an output script.
+    static short_hash to_script_key(const hash_digest& script_hash);
+
+    /// The history key of the sha256 hash of the output script.
+    static short_hash to_script_key(const chain::script& script);
+
+    /// A row of an address history, at the block height of its transaction.
+    struct row
+    {
+        chain::payment_record payment;
+        size_t height;
+        uint64_t value;
+    };
+
+    typedef std::vector<row> row_list;
+
+    /// Totals of an address history, maintained by store and pop.
+    struct summary
+    {
+        /// Satoshis of output rows.
+        uint64_t received;
+
+        /// Satoshis of input rows, where the previous output was known.
+        uint64_t spent;
+
+        /// The number of rows.
+        size_t rows;
+
+        /// The heights of the oldest and newest rows (zero if no rows).
+        size_t first_height;
+        size_t last_height;
+    };
 
     /// Construct the database.
     address_database(const path& lookup_filename, const path& rows_filename,
@@ -63,17 +144,41 @@ public:
     /// Call to unload the memory map.
     bool close();
 
+    /// Log in-place writes to the memory maps, call after start.
+    bool attach(write_log& log);
+
     // Queries.
     //-------------------------------------------------------------------------
 
     /// Get the output and input points associated with the address hash.
     address_result get(const short_hash& hash) const;
 
+    /// Get up to limit rows of the address, newest first, with heights in
+    /// [from_height, to_height], starting at the cursor. The cursor is set
+    /// for resumption of the query, or to last_cursor if it is complete.
+    /// Pages with no heights in the range are skipped without being read.
+    payment_list get(const short_hash& hash, size_t from_height,
+        size_t to_height, size_t limit, cursor& cursor) const;
+
+    /// Get the totals of the address history, false if never stored.
+    bool get_summary(summary& out_summary, const short_hash& hash) const;
+
+    /// The number of blocks of the block index that have been indexed.
+    size_t indexed() const;
+
     // Store.
     //-------------------------------------------------------------------------
 
-    /// Add a row for the key. If key doesn't exist it will be created.
-    void store(const short_hash& hash, const chain::payment_record& payment);
+    /// Add a row for the key at the block height of its transaction, with
+    /// the value received by an output or spent by an input (zero if not
+    /// known). If key doesn't exist it will be created.
+    void store(const short_hash& hash, const chain::payment_record& payment,
+        size_t height, uint64_t value);
+
+    /// Add the rows for the key, oldest first. Rows that do not fit in the
+    /// newest page are written to new pages of up to page_capacity rows, so
+    /// that a history stored in bulk is contiguous.
+    void store(const short_hash& hash, const row_list& rows);
 
     // Update.
     //-------------------------------------------------------------------------
@@ -81,28 +186,45 @@ public:
     /// Logically delete the last row that was added to key.
     bool pop(const short_hash& hash);
 
+    /// Set the number of indexed blocks, persisted on commit.
+    void set_indexed(size_t count);
+
 private:
     typedef short_hash key_type;
     typedef array_index index_type;
     typedef array_index link_type;
+    typedef file_offset page_type;
     typedef record_manager<link_type> manager_type;
+    typedef slab_manager<page_type> page_manager;
     typedef hash_table<manager_type, index_type, link_type, key_type>
         record_map;
 
-    // The record multimap as distinct file as opposed to linkage within the map
-    // allows avoidance of hash storage with each entry. This is similar to
-    // the transaction index with the exception that the tx index stores tx
-    // sets by block in a contiguous array, eliminating a need for linked list.
-    typedef hash_table_multimap<index_type, link_type, key_type> record_multimap;
+    // Read the link of the newest page of the address history.
+    page_type read_root(const short_hash& hash) const;
+
+    // Add the rows in [first, last) to the history of the key.
+    void store(const short_hash& hash, const row* first, const row* last);
+
+    // Allocate and write an empty page, linked to the next page.
+    page_type allocate(page_type next, size_t capacity, size_t size);
 
-    /// Hash table used for start index lookup for linked list by address hash.
+    // Read and write the indexed block count in the page file header.
+    void read_indexed();
+    void write_indexed();
+
+    /// Hash table used for newest page lookup by address hash.
     file_storage hash_table_file_;
     record_map hash_table_;
 
-    /// History rows.
+    /// History pages.
     file_storage address_index_file_;
-    manager_type address_index_;
-    record_multimap address_multimap_;
+    page_manager address_index_;
+
+    // This guards root page links and page row counts.
+    mutable shared_mutex mutex_;
+
+    // The indexed block count, read by queries while indexing.
+    std::atomic<size_t> indexed_;
 };
 
 } // namespace database
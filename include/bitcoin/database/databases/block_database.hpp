@@ -21,10 +21,15 @@
 
 #include <atomic>
 #include <cstddef>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/header_cache.hpp>
+#include <bitcoin/database/header_columns.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
+#include <bitcoin/database/merkle_cache.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/result/block_result.hpp>
@@ -39,11 +44,13 @@ class BCD_API block_database
 {
 public:
     typedef boost::filesystem::path path;
-
     /// Construct the database.
     block_database(const path& map_filename, const path& header_index_filename,
         const path& block_index_filename, const path& tx_index_filename,
-        size_t buckets, size_t expansion);
+        const path& short_id_index_filename,
+        const path& tx_hash_index_filename, const path& pent_index_filename,
+        size_t buckets, size_t expansion, bool cache_headers=false,
+        size_t merkle_capacity=0);
 
     /// Close the database (all threads must first be stopped).
     ~block_database();
@@ -66,6 +73,9 @@ public:
     /// Call to unload the memory map.
     bool close();
 
+    /// Log in-place writes to the memory maps, call after start.
+    bool attach(write_log& log);
+
     // Queries.
     //-------------------------------------------------------------------------
 
@@ -79,17 +89,54 @@ public:
     bool top(size_t& out_height, bool block_index=true) const;
 
     /// Fetch block by block|header index height.
+    /// Header index queries are memory reads if headers are cached.
     block_result get(size_t height, bool block_index=true) const;
 
     /// Fetch block by hash.
     block_result get(const hash_digest& hash) const;
 
+    /// Fetch up to count blocks by block|header index height, from height.
+    /// Metadata for the range is read under one lock in one index pass.
+    block_result::list get_range(size_t from, size_t count,
+        bool block_index=true) const;
+
+    /// Header index values for chain state, empty if headers not cached.
+    const header_columns& columns() const;
+
+    /// Fetch up to limit header index heights above the given height of
+    /// blocks that are pent and not yet populated, in height order.
+    void pent_heights(std::vector<size_t>& out_heights, size_t above,
+        size_t limit) const;
+
+    /// Fetch the link of the tx at position in the block at index height.
+    bool transaction_link(file_offset& out_link, size_t height,
+        size_t position, bool block_index=true) const;
+
+    /// Fetch the cumulative proof of work of the block's branch.
+    bool work(uint256_t& out_work, const hash_digest& hash) const;
+
+    /// Fetch the transaction hashes of the populated block, in order.
+    bool transaction_hashes(hash_list& out_hashes,
+        const hash_digest& hash) const;
+
+    /// Fetch the Merkle branch of the tx at position in the populated block.
+    bool merkle_branch(hash_list& out_branch, const hash_digest& hash,
+        size_t position) const;
+
+    /// Fetch the BIP152 nonce and (wtxid) short ids of the populated block.
+    bool short_ids(uint64_t& out_nonce, short_id_list& out_ids,
+        const hash_digest& hash) const;
+
     // Store.
     // ------------------------------------------------------------------------
 
     /// Push header, validated at height.
     void push(const chain::header& header, size_t height);
 
+    /// Push headers, validated from first_height, in one index allocation.
+    void push(const message::header::const_ptr_list& headers,
+        size_t first_height);
+
     /// Push block, validated at height, and associate tx links.
     void push(const chain::block& block, size_t height,
         uint32_t median_time_past);
@@ -119,20 +166,45 @@ private:
     typedef message::compact_block::short_id_list short_id_list;
 
     uint8_t confirm(const_element& element, bool positive, bool block_index);
-    link_type associate(const chain::transaction::list& transactions);
+    link_type associate(const chain::block& block);
+    link_type store(const chain::header& header, size_t height,
+        uint32_t median_time_past, uint32_t checksum, link_type tx_start,
+        size_t tx_count, uint8_t status);
     void push(const chain::header& header, size_t height,
         uint32_t median_time_past, uint32_t checksum, link_type tx_start,
         size_t tx_count, uint8_t status);
 
+    bool read_transactions(array_index& out_start, size_t& out_count,
+        const const_element& element) const;
+    uint256_t read_work(const hash_digest& hash) const;
+    static hash_digest to_hash(uint256_t work);
+
     // Index Utilities.
     bool read_top(size_t& out_height, const manager_type& manager) const;
     link_type read_index(size_t height, const manager_type& manager) const;
     void pop_index(size_t height, manager_type& manager);
     void push_index(link_type index, size_t height, manager_type& manager);
+    void write_index(link_type index, size_t height, manager_type& manager);
+
+    // Pent Utilities.
+    void index_pent(link_type index, size_t height);
+    void clear_pent(const const_element& element);
+    void write_pent(size_t height, bool pent);
+
+    // Chaser Point Utilities.
+    bool read_points();
+    void write_points();
+
+    // Header Cache Utilities.
+    data_chunk read_value(const const_element& element,
+        size_t& out_height) const;
+    void cache_push(link_type index, size_t height);
+    void cache_update(const const_element& element);
 
     static const size_t prefix_size_;
 
     // The top confirmed block in the header index.
+    // Persisted with valid point in the header of the header index file.
     std::atomic<size_t> fork_point_;
 
     // The top valid block in the header index.
@@ -156,8 +228,31 @@ private:
     file_storage tx_index_file_;
     manager_type tx_index_;
 
+    // Transaction hashes, parallel to the transaction index.
+    file_storage tx_hash_index_file_;
+    manager_type tx_hash_index_;
+
+    // Bitmap of header index heights of pent and unpopulated blocks.
+    // Each record is one byte of eight heights, protected by pent mutex.
+    file_storage pent_index_file_;
+    manager_type pent_index_;
+    mutable shared_mutex pent_mutex_;
+
+    // Precomputed BIP152 short ids, parallel to the transaction index.
+    // The ids are keyed on a nonce derived from the block hash.
+    file_storage short_id_index_file_;
+    manager_type short_id_index_;
+
     // This provides atomicity for checksum, tx_start, tx_count, state.
     mutable shared_mutex metadata_mutex_;
+
+    // Optional in-memory copy of the header index and its block records.
+    const bool cache_headers_;
+    header_cache header_cache_;
+    header_columns header_columns_;
+
+    // Recently queried Merkle trees, populated by const queries.
+    mutable merkle_cache merkle_cache_;
 };
 
 } // namespace database
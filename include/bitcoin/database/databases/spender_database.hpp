@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_SPENDER_DATABASE_HPP
+#define LIBBITCOIN_DATABASE_SPENDER_DATABASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
+#include <bitcoin/database/primitives/hash_table.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This maps each previous output spent by a confirmed transaction to the
+/// input that spends it. Points are referenced by transaction link and index.
+class BCD_API spender_database
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// The link of a transaction and the index of one of its inputs|outputs.
+    typedef std::pair<file_offset, uint32_t> point;
+
+    /// Construct the database.
+    spender_database(const path& lookup_filename, size_t buckets,
+        size_t expansion);
+
+    /// Close the database (all threads must first be stopped).
+    ~spender_database();
+
+    // Startup and shutdown.
+    // ------------------------------------------------------------------------
+
+    /// Initialize a new spender database.
+    bool create();
+
+    /// Call before using the database.
+    bool open();
+
+    /// Commit latest inserts.
+    void commit();
+
+    /// Flush the memory map to disk.
+    bool flush() const;
+
+    /// Call to unload the memory map.
+    bool close();
+
+    /// Log in-place writes to the memory maps, call after start.
+    bool attach(write_log& log);
+
+    // Queries.
+    //-------------------------------------------------------------------------
+
+    /// Fetch the input that spends the output, false if not spent.
+    bool get(point& out_inpoint, const point& outpoint) const;
+
+    // Store.
+    //-------------------------------------------------------------------------
+
+    /// Store the input that spends the output.
+    void store(const point& outpoint, const point& inpoint);
+
+    // Update.
+    //-------------------------------------------------------------------------
+
+    /// Remove the spender of the output, false if not found.
+    bool unlink(const point& outpoint);
+
+private:
+    typedef byte_array<sizeof(file_offset) + sizeof(uint32_t)> key_type;
+    typedef array_index index_type;
+    typedef array_index link_type;
+    typedef record_manager<link_type> manager_type;
+    typedef hash_table<manager_type, index_type, link_type, key_type>
+        record_map;
+
+    static key_type to_key(const point& outpoint);
+
+    // Hash table used for spender lookup by output point.
+    file_storage lookup_file_;
+    record_map lookup_map_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
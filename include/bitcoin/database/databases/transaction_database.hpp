@@ -24,6 +24,7 @@
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/slab_manager.hpp>
 #include <bitcoin/database/result/transaction_result.hpp>
@@ -44,8 +45,9 @@ public:
     typedef boost::filesystem::path path;
 
     /// Construct the database.
-    transaction_database(const path& map_filename, size_t buckets,
-        size_t expansion, size_t cache_capacity);
+    transaction_database(const path& map_filename,
+        const path& witness_filename, size_t buckets, size_t expansion,
+        size_t cache_capacity);
 
     /// Close the database (all threads must first be stopped).
     ~transaction_database();
@@ -62,12 +64,15 @@ public:
     /// Commit latest inserts.
     void commit();
 
-    /// Flush the memory map to disk.
+    /// Flush the memory maps to disk.
     bool flush() const;
 
-    /// Call to unload the memory map.
+    /// Call to unload the memory maps.
     bool close();
 
+    /// Log in-place writes to the memory maps, call after start.
+    bool attach(write_log& log);
+
     // Queries.
     //-------------------------------------------------------------------------
 
@@ -100,6 +105,12 @@ public:
     // Demote the transaction to pooled.
     bool unconfirm(file_offset link);
 
+    // Demote the transaction to pooled, leaving its previous outputs spent.
+    bool demote(file_offset link);
+
+    // Unspend the output at index of the transaction at link.
+    bool unspend(file_offset link, uint32_t index);
+
 private:
     typedef hash_digest key_type;
     typedef array_index index_type;
@@ -109,6 +120,7 @@ private:
 
     // Update the spender height of the output.
     bool spend(const chain::output_point& point, size_t spender_height);
+    bool spend(link_type link, uint32_t index, size_t spender_height);
 
     // Unspend the output.
     bool unspend(const chain::output_point& point);
@@ -117,10 +129,17 @@ private:
     bool update(link_type link, size_t height, uint32_t median_time_past,
         size_t position, transaction_state state);
 
+    // Store the witnesses of a segregated tx, returning the slab link.
+    link_type store_witness(const chain::transaction& tx);
+
     // Hash table used for looking up txs by hash.
     file_storage hash_table_file_;
     slab_map hash_table_;
 
+    // Witness slabs, read only when a tx is requested with witness.
+    file_storage witness_file_;
+    manager_type witness_manager_;
+
     // This is thread safe, and as a cache is mutable.
     mutable unspent_outputs cache_;
 
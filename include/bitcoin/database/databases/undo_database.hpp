@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_UNDO_DATABASE_HPP
+#define LIBBITCOIN_DATABASE_UNDO_DATABASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This is a journal of the reversible effects of confirming each block,
+/// indexed by block index height. A block pop replays its journal in place
+/// of rederiving the effects from the block's transactions.
+class BCD_API undo_database
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// The link of a previous output's transaction and the output's index.
+    typedef std::pair<file_offset, uint32_t> spend;
+    typedef std::vector<spend> spend_list;
+
+    /// Construct the database.
+    undo_database(const path& index_filename, const path& journal_filename,
+        size_t expansion);
+
+    /// Close the database (all threads must first be stopped).
+    ~undo_database();
+
+    // Startup and shutdown.
+    // ------------------------------------------------------------------------
+
+    /// Initialize a new undo database.
+    bool create();
+
+    /// Call before using the database.
+    bool open();
+
+    /// Commit latest inserts.
+    void commit();
+
+    /// Flush the memory maps to disk.
+    bool flush() const;
+
+    /// Call to unload the memory maps.
+    bool close();
+
+    /// Log in-place writes to the memory maps, call after start.
+    bool attach(write_log& log);
+
+    // Queries.
+    //-------------------------------------------------------------------------
+
+    /// Fetch the journal of the block at block index height.
+    /// False if no journal was stored for the height.
+    bool get(spend_list& out_spends, short_hash_list& out_rows,
+        size_t height) const;
+
+    /// True if address rows were journaled for the block at the height.
+    bool has_rows(size_t height) const;
+
+    // Store.
+    //-------------------------------------------------------------------------
+
+    /// Store the journal of the block at the next block index height.
+    /// Rows are address hashes in the order their rows were stored.
+    bool store(const spend_list& spends, const short_hash_list& rows,
+        size_t height);
+
+    /// Store the journal of the block at the next block index height, for a
+    /// block of which address rows are not indexed at confirmation.
+    bool store(const spend_list& spends, size_t height);
+
+    // Update.
+    //-------------------------------------------------------------------------
+
+    /// Remove the journal at the top block index height, or the skipped
+    /// height without a journal. True if the height is above the index.
+    bool pop(size_t height);
+
+private:
+    typedef array_index index_type;
+    typedef file_offset link_type;
+    typedef record_manager<index_type> index_manager;
+    typedef slab_manager<link_type> journal_manager;
+
+    // Read the journal slab link of the height, not_allocated if none.
+    link_type read_link(size_t height) const;
+
+    bool store(const spend_list& spends, const short_hash_list& rows,
+        bool with_rows, size_t height);
+
+    // Journal slab links by block index height.
+    file_storage index_file_;
+    index_manager index_;
+
+    // Journal slabs, read only when a block is popped.
+    file_storage journal_file_;
+    journal_manager journal_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_HEADER_CACHE_HPP
+#define LIBBITCOIN_DATABASE_HEADER_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A contiguous height-indexed copy of header index records, each with its
+/// hash table link and key. Reads are memory copies that do not touch the
+/// store or contend with the store metadata mutex.
+class BCD_API header_cache
+  : noncopyable
+{
+public:
+    typedef byte_serializer::functor write_function;
+    typedef byte_deserializer::functor read_function;
+
+    /// Construct a cache for records of the given value size.
+    header_cache(size_t value_size);
+
+    /// The cache has no elements.
+    bool empty() const;
+
+    /// The number of cached heights.
+    size_t size() const;
+
+    /// Reserve memory for the given number of heights.
+    void reserve(size_t count);
+
+    /// Drop all cached records.
+    void clear();
+
+    /// Append the record value of link at height, which must equal size.
+    void push(array_index link, const hash_digest& key, size_t height,
+        const data_chunk& value);
+
+    /// Truncate the cache to height, which must be the top height.
+    void pop(size_t height);
+
+    /// Get the link of the record cached at height.
+    bool link(array_index& out_link, size_t height) const;
+
+    /// Read the record value cached at height if it has the given link.
+    bool read(hash_digest& out_key, array_index link, size_t height,
+        read_function reader) const;
+
+    /// Write to the record value cached at height if it has the given link.
+    bool write(array_index link, size_t height, write_function writer);
+
+private:
+    uint8_t* record(size_t height) const;
+
+    const size_t value_size_;
+    const size_t record_size_;
+
+    // These are protected by mutex.
+    data_chunk records_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_HEADER_COLUMNS_HPP
+#define LIBBITCOIN_DATABASE_HEADER_COLUMNS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// Height-indexed arrays of the header values used in chain state
+/// construction. Ranges are copied out, as a reference into the arrays
+/// would be invalidated by a concurrent push.
+class BCD_API header_columns
+  : noncopyable
+{
+public:
+    typedef std::vector<uint32_t> column;
+
+    /// The number of heights in the columns.
+    size_t size() const;
+
+    /// Reserve memory for the given number of heights.
+    void reserve(size_t count);
+
+    /// Drop all heights.
+    void clear();
+
+    /// Append the header values at height, which must equal size.
+    /// The median time past is computed from the preceding timestamps.
+    void push(const chain::header& header, size_t height);
+
+    /// Truncate the columns to height, which must be the top height.
+    void pop(size_t height);
+
+    /// Read count versions from height, false if out of range.
+    bool versions(column& out, size_t from, size_t count) const;
+
+    /// Read count timestamps from height, false if out of range.
+    bool timestamps(column& out, size_t from, size_t count) const;
+
+    /// Read count bits from height, false if out of range.
+    bool bits(column& out, size_t from, size_t count) const;
+
+    /// Read count median time past values from height, false if out of range.
+    bool median_time_pasts(column& out, size_t from, size_t count) const;
+
+private:
+    uint32_t median_time_past() const;
+    bool read(column& out, const column& source, size_t from,
+        size_t count) const;
+
+    // These are protected by mutex.
+    column versions_;
+    column timestamps_;
+    column bits_;
+    column median_time_pasts_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
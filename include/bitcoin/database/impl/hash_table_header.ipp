@@ -114,6 +114,7 @@ void hash_table_header<Index, Link>::write(Index index, Link value)
     ///////////////////////////////////////////////////////////////////////////
     unique_lock lock(mutex_);
     serial.template write_little_endian<Link>(value);
+    file_.log_write(memory->buffer(), sizeof(Link));
     ///////////////////////////////////////////////////////////////////////////
 }
 
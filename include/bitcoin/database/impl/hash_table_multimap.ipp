@@ -143,6 +143,7 @@ void hash_table_multimap<Index, Link, Key>::link(const Key& key,
 
         // "link" existing root to the new first element.
         root.write(writer);
+        root.log(0, sizeof(Link));
     }
 
     root_mutex_.unlock();
@@ -199,6 +200,7 @@ bool hash_table_multimap<Index, Link, Key>::unlink(const Key& key)
     root_mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
     root.write(writer);
+    root.log(0, sizeof(Link));
 
     root_mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
@@ -113,6 +113,15 @@ void list_element<Manager, Link, Key>::write(write_function writer) const
     writer(serial);
 }
 
+// Log an in-place write to the payload, made by a preceding call to write.
+template <typename Manager, typename Link, typename Key>
+void list_element<Manager, Link, Key>::log(size_t offset, size_t size) const
+{
+    const auto memory = data(std::tuple_size<Key>::value + sizeof(Link) +
+        offset);
+    manager_.log_write(memory->buffer(), size);
+}
+
 // Jump to the next element in the list.
 template <typename Manager, typename Link, typename Key>
 bool list_element<Manager, Link, Key>::jump_next()
@@ -142,6 +151,7 @@ void list_element<Manager, Link, Key>::set_next(Link next) const
     ///////////////////////////////////////////////////////////////////////////
     unique_lock lock(mutex_);
     serial.template write_little_endian<Link>(next);
+    manager_.log_write(memory->buffer(), sizeof(Link));
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -126,11 +126,31 @@ Link record_manager<Link>::allocate(size_t count)
     if (!file_.reserve(required_size))
         return 0;
 
+    file_.log_allocation(header_size_ + link_to_position(next_record_index));
     record_count_ += count;
     return next_record_index;
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// The count is unchanged, so readers do not see the reserved records.
+template <typename Link>
+Link record_manager<Link>::reserve(size_t count)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const size_t position = link_to_position(record_count_ + count);
+    const size_t required_size = header_size_ + position;
+
+    // Currently throws runtime_error if insufficient space.
+    if (!file_.reserve(required_size))
+        return 0;
+
+    return record_count_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 template <typename Link>
 memory_ptr record_manager<Link>::get(Link link) const
 {
@@ -143,6 +163,12 @@ memory_ptr record_manager<Link>::get(Link link) const
     return memory;
 }
 
+template <typename Link>
+void record_manager<Link>::log_write(const uint8_t* data, size_t size) const
+{
+    file_.log_write(data, size);
+}
+
 // privates
 
 // Read the count value from the first 32 bits of the file after the header.
@@ -169,6 +195,7 @@ void record_manager<Link>::write_count()
     memory->increment(header_size_);
     auto serial = make_unsafe_serializer(memory->buffer());
     serial.template write_little_endian<Link>(record_count_);
+    file_.log_write(memory->buffer(), sizeof(Link));
 }
 
 template <typename Link>
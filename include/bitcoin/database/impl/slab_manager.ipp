@@ -112,6 +112,7 @@ Link slab_manager<Link>::allocate(size_t size)
     if (!file_.reserve(required_size))
         return not_allocated;
 
+    file_.log_allocation(header_size_ + next_slab_position);
     payload_size_ += size;
     return next_slab_position;
     ///////////////////////////////////////////////////////////////////////////
@@ -130,6 +131,12 @@ memory_ptr slab_manager<Link>::get(Link link) const
     return memory;
 }
 
+template <typename Link>
+void slab_manager<Link>::log_write(const uint8_t* data, size_t size) const
+{
+    file_.log_write(data, size);
+}
+
 // privates
 
 // Read the size value from the first 64 bits of the file after the header.
@@ -156,6 +163,7 @@ void slab_manager<Link>::write_size() const
     memory->increment(header_size_);
     auto serial = make_unsafe_serializer(memory->buffer());
     serial.template write_little_endian<Link>(payload_size_);
+    file_.log_write(memory->buffer(), sizeof(Link));
 }
 
 } // namespace database
@@ -36,6 +36,8 @@
 namespace libbitcoin {
 namespace database {
 
+class write_log;
+
 /// This class is thread safe, allowing concurent read and write.
 /// A change to the size of the memory map waits on and locks read and write.
 class BCD_API file_storage
@@ -80,6 +82,22 @@ public:
     /// Increase the physical size to at least the logical size.
     memory_ptr reserve(size_t size);
 
+    /// Log in-place writes as the file of the index (see write_log::attach).
+    void attach(write_log& log, size_t index);
+
+    /// Log an in-place write of size bytes, within an accessed map.
+    void log_write(const uint8_t* data, size_t size);
+
+    /// Mark the start of an allocation, for flush_allocations.
+    void log_allocation(size_t offset);
+
+    /// Flush the memory map from the first allocation since the last flush.
+    /// Log reallocated space, as it may be the target of logged writes.
+    bool flush_allocations();
+
+    /// The path of the file.
+    const path& filename() const;
+
 private:
     static size_t file_size(int file_handle);
     static int open_file(const boost::filesystem::path& filename);
@@ -112,6 +130,16 @@ private:
     size_t file_size_;
     size_t logical_size_;
     mutable upgrade_mutex mutex_;
+
+    // Set at startup, before any write.
+    write_log* log_;
+    size_t log_index_;
+
+    // The lowest allocation and reallocation offsets since the last flush,
+    // and the logical size below which allocation is reallocation.
+    mutable std::atomic<size_t> allocated_;
+    mutable std::atomic<size_t> reallocated_;
+    mutable std::atomic<size_t> allocated_size_;
 };
 
 } // namespace database
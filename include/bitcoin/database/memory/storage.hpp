@@ -56,6 +56,12 @@ public:
     /// Resize the logical map to the specified size, return access.
     /// Increase the physical size to at least the logical size.
     virtual memory_ptr reserve(size_t size) = 0;
+
+    /// Record an in-place write of size bytes, within an accessed map.
+    virtual void log_write(const uint8_t* data, size_t size) = 0;
+
+    /// Record an allocation starting at the offset, flushed before logging.
+    virtual void log_allocation(size_t offset) = 0;
 };
 
 } // namespace database
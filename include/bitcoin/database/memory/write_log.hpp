@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_WRITE_LOG_HPP
+#define LIBBITCOIN_DATABASE_WRITE_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+class file_storage;
+
+/// This class is thread safe.
+/// A redo log of the in-place writes to memory mapped files. Allocated space
+/// is flushed and the log (only) is synced when no write is in progress, so
+/// that each batch of the log completes one or more write sequences. After a
+/// crash the batches are replayed onto the files, in place of flushing the
+/// files after each write sequence.
+class BCD_API write_log
+  : noncopyable
+{
+public:
+    typedef boost::filesystem::path path;
+    typedef std::vector<path> paths;
+    typedef std::function<bool()> flush_handler;
+    typedef std::function<bool()> sequence_handler;
+    typedef std::function<bool(size_t file, file_offset offset,
+        const data_chunk& data)> replay_handler;
+
+    /// The log size above which the files are flushed and the log reset.
+    static const size_t checkpoint_size;
+
+    /// Construct the log of writes to the files, which are logged by index.
+    write_log(const path& filename, const paths& files);
+
+    /// Close the log.
+    ~write_log();
+
+    // Startup and shutdown.
+    // ------------------------------------------------------------------------
+
+    /// Open the log file, created if missing.
+    bool open();
+
+    /// Close the log file, buffered writes are discarded.
+    bool close();
+
+    /// Log writes to the file, which must be one of the logged files.
+    bool attach(file_storage& file);
+
+    // Logging.
+    // ------------------------------------------------------------------------
+
+    /// Buffer the image of size bytes at the offset of the file.
+    void write(size_t file, file_offset offset, const uint8_t* data,
+        size_t size);
+
+    /// Start a write sequence. If no other sequence is in progress, invoke
+    /// the start handler first, and if it fails do not start the sequence.
+    bool begin(sequence_handler start);
+
+    /// End a write sequence. If no other sequence is in progress, flush the
+    /// allocated space of attached files, append the buffered writes as one
+    /// batch and sync the log. Checkpoint if the log size is exceeded, and
+    /// then invoke the stop handler.
+    bool end(flush_handler flush, sequence_handler stop);
+
+    // Recovery.
+    // ------------------------------------------------------------------------
+
+    /// Replay the complete batches of the log in order, a torn last batch is
+    /// ignored. False if the handler fails.
+    bool replay(replay_handler handler) const;
+
+    /// Discard all batches, the files must have been flushed.
+    bool reset();
+
+    /// The size of the log file.
+    size_t size() const;
+
+    /// The logged files, by index.
+    const paths& files() const;
+
+private:
+    bool commit();
+
+    const path filename_;
+    const paths files_;
+    int file_handle_;
+    size_t size_;
+
+    // These are protected by sequence_mutex_.
+    size_t sequences_;
+    std::vector<file_storage*> attached_;
+    mutable shared_mutex sequence_mutex_;
+
+    // This is protected by buffer_mutex_.
+    data_chunk buffer_;
+    mutable shared_mutex buffer_mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_MERKLE_CACHE_HPP
+#define LIBBITCOIN_DATABASE_MERKLE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <boost/bimap.hpp>
+#include <boost/bimap/set_of.hpp>
+#include <boost/bimap/unordered_set_of.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A least-recently-used cache of block Merkle trees, by block hash.
+class BCD_API merkle_cache
+  : noncopyable
+{
+public:
+    /// Tree levels, from the transaction hashes (zero) to the root.
+    typedef std::vector<hash_list> tree;
+    typedef std::shared_ptr<const tree> tree_ptr;
+
+    /// Build the Merkle tree of the transaction hashes (must not be empty).
+    static tree_ptr build(hash_list&& hashes);
+
+    /// The Merkle branch of the leaf at position, from the leaf level up.
+    static hash_list branch(const tree& tree, size_t position);
+
+    /// Construct a cache with the specified block count limit.
+    merkle_cache(size_t capacity);
+
+    /// The cache capacity is zero.
+    bool disabled() const;
+
+    /// The number of trees in the cache.
+    size_t size() const;
+
+    /// Add the tree of the block, removing the least recently used.
+    void add(const hash_digest& block_hash, tree_ptr tree);
+
+    /// Get the tree of the block, null if not cached (marks it used).
+    tree_ptr find(const hash_digest& block_hash);
+
+private:
+    // The right view orders blocks by sequence of last use.
+    typedef boost::bimaps::bimap<
+        boost::bimaps::unordered_set_of<hash_digest, std::hash<hash_digest>>,
+        boost::bimaps::set_of<uint32_t>,
+        boost::bimaps::with_info<tree_ptr>> trees;
+
+    // This is thread safe.
+    const size_t capacity_;
+
+    // These are protected by mutex.
+    uint32_t sequence_;
+    trees trees_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -69,6 +69,9 @@ public:
     /// Write to the state of the element (write to file).
     void write(write_function writer) const;
 
+    /// Log an in-place write of size bytes at the offset of the state.
+    void log(size_t offset, size_t size) const;
+
     /// Read from the state of the element.
     void read(read_function reader) const;
 
@@ -61,9 +61,17 @@ public:
     /// Allocate records and return first logical index, commit after writing.
     Link allocate(size_t count);
 
+    /// Reserve space for records after the last and return the first logical
+    /// index, without counting them. Records written to reserved space are
+    /// published by allocating the same count.
+    Link reserve(size_t count);
+
     /// Return memory object for the record at the specified index.
     memory_ptr get(Link link) const;
 
+    /// Log an in-place write of size bytes, within an accessed record.
+    void log_write(const uint8_t* data, size_t size) const;
+
 private:
     // The record index of a disk position.
     Link position_to_link(file_offset position) const;
@@ -60,6 +60,9 @@ public:
     /// Return memory object for the slab at the specified position.
     memory_ptr get(Link position) const;
 
+    /// Log an in-place write of size bytes, within an accessed slab.
+    void log_write(const uint8_t* data, size_t size) const;
+
 private:
     // Read the size of the data from the file.
     void read_size();
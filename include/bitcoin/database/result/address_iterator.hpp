@@ -20,10 +20,10 @@
 #define LIBBITCOIN_DATABASE_ADDRESS_ITERATOR_HPP
 
 #include <cstddef>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
-#include <bitcoin/database/primitives/list_element.hpp>
-#include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -33,8 +33,8 @@ class BCD_API address_iterator
 public:
     // Definition for underlying type (avoids circular reference).
     //-------------------------------------------------------------------------
-    typedef list_element<const record_manager<array_index>, array_index,
-        empty_key> const_element;
+    typedef file_offset link_type;
+    typedef slab_manager<link_type> manager;
 
     // std::iterator_traits
     //-------------------------------------------------------------------------
@@ -50,7 +50,8 @@ public:
     // Constructors.
     //-------------------------------------------------------------------------
 
-    address_iterator(const const_element& element);
+    address_iterator(const manager& manager, shared_mutex& mutex,
+        link_type page);
 
     // Operators.
     //-------------------------------------------------------------------------
@@ -64,9 +65,16 @@ public:
 
 private:
     void populate();
+    void increment();
 
-    const_element element_;
-    value_type payment_;
+    const manager& manager_;
+    shared_mutex& mutex_;
+    link_type page_;
+    link_type next_;
+
+    // The rows of the current page, newest first.
+    std::vector<value_type> payments_;
+    size_t index_;
 };
 
 } // namespace database
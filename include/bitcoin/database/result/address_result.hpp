@@ -22,8 +22,7 @@
 #include <cstddef>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
-#include <bitcoin/database/primitives/list_element.hpp>
-#include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
 #include <bitcoin/database/result/address_iterator.hpp>
 
 namespace libbitcoin {
@@ -33,28 +32,31 @@ namespace database {
 class BCD_API address_result
 {
 public:
-    typedef empty_key key_type;
-    typedef array_index link_type;
-    typedef record_manager<link_type> manager;
-    typedef list_element<const manager, link_type, key_type> const_value_type;
+    typedef file_offset link_type;
+    typedef slab_manager<link_type> manager;
 
-    address_result(const const_value_type& element, const short_hash& hash);
+    address_result(const manager& manager, shared_mutex& mutex,
+        link_type page, const short_hash& hash);
 
-    /// True if the requested block exists.
+    /// True if the requested address has history.
     operator bool() const;
 
     /// The address hash of the query.
     const short_hash& hash() const;
 
-    /// Iterate over the address metadata set.
+    /// Iterate over the address metadata set, newest first.
     address_iterator begin() const;
     address_iterator end() const;
 
 private:
     short_hash hash_;
+    link_type page_;
 
     // This class is thread safe.
-    const_value_type element_;
+    const manager& manager_;
+
+    // Page row counts are kept consistent by mutex.
+    shared_mutex& mutex_;
 };
 
 } // namespace database
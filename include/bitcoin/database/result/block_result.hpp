@@ -21,8 +21,10 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/header_cache.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/result/transaction_iterator.hpp>
@@ -41,10 +43,23 @@ public:
     typedef record_manager<link_type> manager;
     typedef list_element<const manager, link_type, key_type>
         const_element_type;
+    typedef std::vector<block_result> list;
 
     block_result(const const_element_type& element,
         shared_mutex& metadata_mutex, const manager& index_manager);
 
+    /// Read from the cached copy of the element record at header height.
+    /// Falls back to the element if the cached height has been reorganized.
+    block_result(const const_element_type& element,
+        shared_mutex& metadata_mutex, const manager& index_manager,
+        const header_cache& cache, size_t height);
+
+    /// Read from a copy of the element record value, read under the
+    /// metadata lock by the caller.
+    block_result(const const_element_type& element,
+        shared_mutex& metadata_mutex, const manager& index_manager,
+        data_chunk&& value);
+
     /// True if the requested block exists.
     operator bool() const;
 
@@ -75,12 +90,18 @@ public:
     /// The height of the block (independent of chain).
     size_t height() const;
 
+    /// The cumulative proof of work of the block's branch.
+    uint256_t work() const;
+
     /// The state of the block (flags).
     uint8_t state() const;
 
-    /// The full block p2p message checksum (presumed invalid if zero).
+    /// The CRC32C of the block's transactions (not populated if zero).
     uint32_t checksum() const;
 
+    /// True if the checksum is not populated or matches the transactions.
+    bool verify(const chain::transaction::list& transactions) const;
+
     /// The number of transactions in this block (may be zero).
     size_t transaction_count() const;
 
@@ -89,9 +110,13 @@ public:
     transaction_iterator end() const;
 
 private:
+    void populate();
+    void deserialize(byte_deserializer& deserial, hash_digest&& hash);
+
     chain::header header_;
     uint32_t median_time_past_;
     uint32_t height_;
+    uint256_t work_;
     uint8_t state_;
     uint32_t checksum_;
     array_index tx_start_;
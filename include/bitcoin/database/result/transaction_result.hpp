@@ -47,8 +47,11 @@ public:
     /// This is unconfirmed tx position sentinel.
     static const uint16_t unconfirmed;
 
+    /// This is the witness link sentinel for a non-segregated tx.
+    static const file_offset unwitnessed;
+
     transaction_result(const const_element_type& element,
-        shared_mutex& metadata_mutex);
+        shared_mutex& metadata_mutex, const manager& witness_manager);
 
     /// True if this transaction result is valid (found).
     operator bool() const;
@@ -80,7 +83,7 @@ public:
     /// The output at the specified index within this transaction.
     chain::output output(uint32_t index) const;
 
-    /// The transaction, optionally including witness.
+    /// The transaction, optionally including witness (read separately).
     chain::transaction transaction(bool witness=true) const;
 
     /// Iterate over the input set.
@@ -92,9 +95,11 @@ private:
     uint16_t position_;
     transaction_state state_;
     uint32_t median_time_past_;
+    file_offset witness_;
 
-    // This class is thread safe.
+    // These classes are thread safe.
     const const_element_type element_;
+    const manager& witness_manager_;
 
     // Metadata values are kept consistent by mutex.
     shared_mutex& metadata_mutex_;
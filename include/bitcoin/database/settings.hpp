@@ -36,12 +36,20 @@ public:
     /// Properties.
     boost::filesystem::path directory;
     bool flush_writes;
+    bool log_writes;
     bool index_addresses;
+    uint32_t address_index_threads;
+    bool defer_address_index;
+    bool index_script_hashes;
+    bool index_spends;
+    bool cache_headers;
     uint16_t file_growth_rate;
     uint32_t block_table_buckets;
     uint32_t transaction_table_buckets;
     uint32_t address_table_buckets;
+    uint32_t spend_table_buckets;
     uint32_t cache_capacity;
+    uint32_t merkle_cache_capacity;
 };
 
 } // namespace database
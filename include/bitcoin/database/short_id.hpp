@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_SHORT_ID_HPP
+#define LIBBITCOIN_DATABASE_SHORT_ID_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// The two 64 bit SipHash keys (k0, k1) of a compact block.
+typedef std::pair<uint64_t, uint64_t> short_id_key;
+
+/// SipHash-2-4 of the data under the key.
+BCD_API uint64_t siphash(const short_id_key& key, const uint8_t* data,
+    size_t size);
+
+/// The nonce under which the stored short ids of a block are computed.
+/// This is derived from the block hash so that it is not stored.
+BCD_API uint64_t short_id_nonce(const hash_digest& block_hash);
+
+/// The BIP152 key: the first 16 bytes of sha256(header || nonce).
+BCD_API short_id_key to_short_id_key(const chain::header& header,
+    uint64_t nonce);
+
+/// The BIP152 short id: the low 6 bytes of the SipHash of the tx hash.
+BCD_API mini_hash short_id(const short_id_key& key, const hash_digest& hash);
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_SHORT_ID_MAP_HPP
+#define LIBBITCOIN_DATABASE_SHORT_ID_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/short_id.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// Maps the short ids of transactions, under the key of one compact block,
+/// to their transaction links. Colliding short ids are not resolvable.
+class BCD_API short_id_map
+  : noncopyable
+{
+public:
+    typedef message::compact_block::short_id_list short_id_list;
+    typedef std::vector<file_offset> link_list;
+
+    static const file_offset not_found;
+
+    /// Construct a map for the key of the compact block.
+    short_id_map(const short_id_key& key);
+
+    /// The number of distinct short ids in the map.
+    size_t size() const;
+
+    /// Add the transaction hash (txid or wtxid) of the transaction at link.
+    /// False if the short id collides with that of another transaction.
+    bool add(const hash_digest& hash, file_offset link);
+
+    /// Find the transaction link of the short id.
+    /// False if the short id is not mapped or collides.
+    bool find(file_offset& out_link, const mini_hash& id) const;
+
+    /// Find the transaction links of the short ids, not_found if unmatched.
+    /// Returns the number of short ids matched.
+    size_t match(link_list& out_links, const short_id_list& ids) const;
+
+private:
+    typedef std::unordered_map<uint64_t, file_offset> map;
+
+    static uint64_t to_key(const mini_hash& id);
+
+    const short_id_key key_;
+
+    // This is protected by mutex.
+    map map_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -24,6 +24,7 @@
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -40,14 +41,23 @@ public:
     static const std::string BLOCK_INDEX;
     static const std::string BLOCK_TABLE;
     static const std::string TRANSACTION_INDEX;
+    static const std::string SHORT_ID_INDEX;
+    static const std::string TRANSACTION_HASH_INDEX;
+    static const std::string PENT_INDEX;
     static const std::string TRANSACTION_TABLE;
+    static const std::string TRANSACTION_WITNESS;
+    static const std::string UNDO_INDEX;
+    static const std::string UNDO_TABLE;
     static const std::string ADDRESS_TABLE;
     static const std::string ADDRESS_ROWS;
+    static const std::string SPEND_TABLE;
+    static const std::string WRITE_LOG;
 
     // Construct.
     // ------------------------------------------------------------------------
 
-    store(const path& prefix, bool with_indexes, bool flush_each_write=false);
+    store(const path& prefix, bool with_indexes, bool flush_each_write=false,
+        bool log_each_write=false);
 
     // Open and close.
     // ------------------------------------------------------------------------
@@ -73,6 +83,9 @@ public:
     /// True if write flushing is enabled.
     virtual bool flush_each_write() const;
 
+    /// True if write logging is enabled (and write flushing is not).
+    virtual bool log_each_write() const;
+
     // File names.
     // ------------------------------------------------------------------------
 
@@ -81,23 +94,36 @@ public:
     const path block_index;
     const path block_table;
     const path transaction_index;
+    const path short_id_index;
+    const path transaction_hash_index;
+    const path pent_index;
     const path transaction_table;
+    const path transaction_witness;
+    const path undo_index;
+    const path undo_table;
 
     /// Optional indexes.
     const path address_table;
     const path address_rows;
+    const path spend_table;
 
 protected:
     // The implementation must flush all data to disk here.
     virtual bool flush() const = 0;
 
+    // The log of in-place writes, for attaching the store files.
+    write_log& write_logger();
 
 private:
+    bool replay();
+
     const path prefix_;
     const bool with_indexes_;
     const bool flush_each_write_;
+    const bool log_each_write_;
     mutable bc::flush_lock flush_lock_;
     mutable interprocess_lock exclusive_lock_;
+    mutable write_log log_;
 };
 
 } // namespace database
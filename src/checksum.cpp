@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/checksum.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+// The crc32 instruction is used on x86 if the processor supports SSE4.2.
+// The software table is compiled only if SSE4.2 is not a build requirement.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+    #define CRC32C_HARDWARE
+    #include <nmmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+#ifndef __SSE4_2__
+    #define CRC32C_SOFTWARE
+#endif
+
+// Enable the instruction for the hardware function only (runtime dispatch).
+#if defined(CRC32C_HARDWARE) && defined(CRC32C_SOFTWARE) && \
+    defined(__GNUC__)
+    #define CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+    #define CRC32C_TARGET
+#endif
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::chain;
+
+#ifdef CRC32C_SOFTWARE
+
+typedef std::array<uint32_t, 256> crc_table;
+
+// CRC32C (Castagnoli) reflected polynomial.
+static constexpr uint32_t polynomial = 0x82f63b78;
+
+static crc_table make_table()
+{
+    crc_table table;
+
+    for (uint32_t byte = 0; byte < table.size(); ++byte)
+    {
+        auto crc = byte;
+
+        for (auto bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+
+        table[byte] = crc;
+    }
+
+    return table;
+}
+
+static uint32_t crc32c_software(uint32_t crc, const uint8_t* data,
+    size_t size)
+{
+    static const auto table = make_table();
+    crc = ~crc;
+
+    for (size_t index = 0; index < size; ++index)
+        crc = table[(crc ^ data[index]) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+#endif
+
+#ifdef CRC32C_HARDWARE
+
+CRC32C_TARGET
+static uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data,
+    size_t size)
+{
+    crc = ~crc;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = crc;
+
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t))
+    {
+        // The crc32 instruction is defined over little-endian words.
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += sizeof(uint64_t);
+    }
+
+    crc = static_cast<uint32_t>(crc64);
+#endif
+
+    for (; size > 0; --size)
+        crc = _mm_crc32_u8(crc, *data++);
+
+    return ~crc;
+}
+
+#endif
+
+#if defined(CRC32C_HARDWARE) && defined(CRC32C_SOFTWARE)
+
+static bool has_sse4_2()
+{
+#ifdef _MSC_VER
+    // SSE4.2 is bit 20 of ecx for cpuid function 1.
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") != 0;
+#endif
+}
+
+uint32_t crc32c(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static const auto hardware = has_sse4_2();
+    return hardware ? crc32c_hardware(crc, data, size) :
+        crc32c_software(crc, data, size);
+}
+
+#elif defined(CRC32C_HARDWARE)
+
+uint32_t crc32c(uint32_t crc, const uint8_t* data, size_t size)
+{
+    return crc32c_hardware(crc, data, size);
+}
+
+#else
+
+uint32_t crc32c(uint32_t crc, const uint8_t* data, size_t size)
+{
+    return crc32c_software(crc, data, size);
+}
+
+#endif
+
+uint32_t checksum(const transaction::list& transactions)
+{
+    uint32_t crc = 0;
+
+    for (const auto& tx: transactions)
+    {
+        const auto data = tx.to_data(true, true);
+        crc = crc32c(crc, data.data(), data.size());
+    }
+
+    return crc;
+}
+
+} // namespace database
+} // namespace libbitcoin
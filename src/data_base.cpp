@@ -22,8 +22,12 @@
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
@@ -40,13 +44,12 @@ using namespace bc::wallet;
 
 #define NAME "data_base"
 
-// TODO: replace spends with complex query, output gets inpoint:
+// Without the optional spend index, the output gets inpoint by query:
 // (1) transactions_.get(outpoint, require_confirmed)->spender_height.
 // (2) blocks_.get(spender_height)->transactions().
 // (3) (transactions()->inputs()->previous_output() == outpoint)->inpoint.
 // This has the same average cost as 1 output-query + 1/2 block-query.
-// This will reduce server indexing by 30% (address indexing only).
-// Could make index optional, redirecting queries if not present.
+// With the spend index (index_spends) it is one spenders_ lookup.
 
 // A failure after begin_write is returned without calling end_write.
 // This leaves the local flush lock enabled, preventing usage after restart.
@@ -64,14 +67,19 @@ static const auto unconfirmed = transaction_result::unconfirmed;
 data_base::data_base(const settings& settings)
   : closed_(true),
     settings_(settings),
-    database::store(settings.directory, settings.index_addresses,
-        settings.flush_writes)
+    pool_leader_(false),
+    indexer_stopped_(true),
+    indexer_pending_(false),
+    deferred_(false),
+    database::store(settings.directory, settings.index_addresses ||
+        settings.index_spends, settings.flush_writes, settings.log_writes)
 {
     LOG_DEBUG(LOG_DATABASE)
         << "Buckets: "
         << "block [" << settings.block_table_buckets << "], "
         << "transaction [" << settings.transaction_table_buckets << "], "
-        << "address [" << settings.address_table_buckets << "]";
+        << "address [" << settings.address_table_buckets << "], "
+        << "spend [" << settings.spend_table_buckets << "]";
 }
 
 data_base::~data_base()
@@ -97,16 +105,25 @@ bool data_base::create(const block& genesis)
     start();
 
     // These leave the databases open.
-    auto created = blocks_->create() && transactions_->create();
+    auto created = blocks_->create() && transactions_->create() &&
+        undos_->create();
 
     if (settings_.index_addresses)
         created &= addresses_->create();
 
+    if (settings_.index_spends)
+        created &= spenders_->create();
+
+    // The genesis block is not indexed if indexing is deferred.
+    deferred_ = settings_.index_addresses && settings_.defer_address_index;
     created &= push_genesis(genesis) == error::success;
 
     if (!created)
         return false;
 
+    if (index_async())
+        start_indexer();
+
     closed_ = false;
     return created;
 }
@@ -122,14 +139,32 @@ bool data_base::open()
 
     start();
 
-    auto opened = blocks_->open() && transactions_->open();
+    auto opened = blocks_->open() && transactions_->open() &&
+        undos_->open();
 
     if (settings_.index_addresses)
         opened &= addresses_->open();
 
+    if (settings_.index_spends)
+        opened &= spenders_->open();
+
     if (!opened)
         return false;
 
+    size_t top;
+    const auto count = blocks_->top(top, true) ? top + 1u : 0u;
+
+    // Indexing remains deferred until built if configured, or if inline
+    // indexing would leave a gap below the blocks of the block index.
+    const auto deferrable = settings_.defer_address_index ||
+        settings_.address_index_threads == 0;
+
+    deferred_ = settings_.index_addresses && deferrable &&
+        addresses_->indexed() < count;
+
+    if (index_async())
+        start_indexer();
+
     closed_ = false;
     return opened;
 }
@@ -138,12 +173,17 @@ bool data_base::open()
 void data_base::start()
 {
     blocks_ = std::make_shared<block_database>(block_table, header_index,
-        block_index, transaction_index, settings_.block_table_buckets,
-        settings_.file_growth_rate);
+        block_index, transaction_index, short_id_index,
+        transaction_hash_index, pent_index, settings_.block_table_buckets,
+        settings_.file_growth_rate, settings_.cache_headers,
+        settings_.merkle_cache_capacity);
 
     transactions_ = std::make_shared<transaction_database>(transaction_table,
-        settings_.transaction_table_buckets, settings_.file_growth_rate,
-        settings_.cache_capacity);
+        transaction_witness, settings_.transaction_table_buckets,
+        settings_.file_growth_rate, settings_.cache_capacity);
+
+    undos_ = std::make_shared<undo_database>(undo_index, undo_table,
+        settings_.file_growth_rate);
 
     if (settings_.index_addresses)
     {
@@ -151,14 +191,43 @@ void data_base::start()
             address_rows, settings_.address_table_buckets,
             settings_.file_growth_rate);
     }
+
+    if (settings_.index_spends)
+    {
+        spenders_ = std::make_shared<spender_database>(spend_table,
+            settings_.spend_table_buckets, settings_.file_growth_rate);
+    }
+
+    if (!log_each_write())
+        return;
+
+    // Attachment fails only for a file that is not a store file.
+    auto& log = write_logger();
+    auto attached = blocks_->attach(log) && transactions_->attach(log) &&
+        undos_->attach(log);
+
+    if (settings_.index_addresses)
+        attached &= addresses_->attach(log);
+
+    if (settings_.index_spends)
+        attached &= spenders_->attach(log);
+
+    if (!attached)
+        LOG_FATAL(LOG_DATABASE)
+            << "Failed to attach the write log.";
 }
 
 // protected
+// Asynchronously indexed addresses are committed by the indexer.
 void data_base::commit()
 {
-    if (settings_.index_addresses)
+    if (index_inline())
         addresses_->commit();
 
+    if (settings_.index_spends)
+        spenders_->commit();
+
+    undos_->commit();
     transactions_->commit();
     blocks_->commit();
 }
@@ -173,11 +242,15 @@ bool data_base::flush() const
     ////if (closed_)
     ////    return true;
 
-    auto flushed = blocks_->flush() && transactions_->flush();
+    auto flushed = blocks_->flush() && transactions_->flush() &&
+        undos_->flush();
 
     if (settings_.index_addresses)
         flushed &= addresses_->flush();
 
+    if (settings_.index_spends)
+        flushed &= spenders_->flush();
+
     LOG_DEBUG(LOG_DATABASE)
         << "Write flushed to disk: "
         << code(flushed ? error::success : error::operation_failed).message();
@@ -193,12 +266,17 @@ bool data_base::close()
         return true;
 
     closed_ = true;
+    stop_indexer();
 
-    auto closed = blocks_->close() && transactions_->close();
+    auto closed = blocks_->close() && transactions_->close() &&
+        undos_->close();
 
     if (settings_.index_addresses)
         closed &= addresses_->close();
 
+    if (settings_.index_spends)
+        closed &= spenders_->close();
+
     return closed && store::close();
     // Unlock exclusive file access and conditionally the global flush lock.
     ///////////////////////////////////////////////////////////////////////////
@@ -224,13 +302,95 @@ const address_database& data_base::addresses() const
     return *addresses_;
 }
 
+// Invalid if spends not indexed.
+const spender_database& data_base::spenders() const
+{
+    return *spenders_;
+}
+
+bool data_base::indexed_height(size_t& out_height) const
+{
+    if (!settings_.index_addresses)
+        return false;
+
+    const auto count = addresses_->indexed();
+
+    if (count == 0)
+        return false;
+
+    out_height = count - 1u;
+    return true;
+}
+
 // Synchronous writers.
 // ----------------------------------------------------------------------------
 // public
 
 // TODO: enable promotion from any unconfirmed state to pooled.
 // This expects tx is validated, unconfirmed and not yet stored.
+// The first caller to find no write in progress leads, writing every queued
+// request (including those queued while it writes) in one write sequence.
 code data_base::store(const transaction& tx, uint32_t forks)
+{
+    pool_request request{ tx, forks, error::success, false };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    pool_queue_.push_back(&request);
+
+    pool_condition_.wait(lock, [&]()
+    {
+        return request.complete || !pool_leader_;
+    });
+
+    if (request.complete)
+        return request.result;
+
+    pool_requests requests;
+    requests.swap(pool_queue_);
+    pool_leader_ = true;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto complete = [&]()
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        lock.lock();
+
+        for (const auto queued: requests)
+            queued->complete = true;
+
+        pool_leader_ = false;
+        lock.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        pool_condition_.notify_all();
+    };
+
+    try
+    {
+        store_pooled(requests);
+    }
+    catch (...)
+    {
+        // A failed write (e.g. file reservation) must not strand the group.
+        for (const auto queued: requests)
+            queued->result = error::operation_failed;
+
+        complete();
+        throw;
+    }
+
+    complete();
+    return request.result;
+}
+
+// TODO: enable promotion from any unconfirmed state (to confirmed).
+// TODO: otherwise this will replace the previously-existing header.
+// This expects header is validated and not yet stored.
+code data_base::push(const chain::header& header, size_t height)
 {
     code ec;
 
@@ -238,27 +398,25 @@ code data_base::store(const transaction& tx, uint32_t forks)
     ///////////////////////////////////////////////////////////////////////////
     unique_lock lock(write_mutex_);
 
-    // Returns error::unspent_duplicate if an unspent tx with same hash exists.
-    if ((ec = verify_push(tx)))
+    if ((ec = verify_push(header, height)))
         return ec;
 
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
-    // When position is unconfirmed, height is used to store validation forks.
-    transactions_->store(tx, forks, no_time, unconfirmed, pool);
-    transactions_->commit();
+    // State is indexed | pent (pending download).
+    blocks_->push(header, height);
+    blocks_->commit();
 
     return end_write() ? error::success : error::store_lock_failure;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
 
-// TODO: enable promotion from any unconfirmed state (to confirmed).
-// TODO: otherwise this will replace the previously-existing header.
-// This expects header is validated and not yet stored.
-code data_base::push(const chain::header& header, size_t height)
+// This expects headers are validated and not yet stored.
+code data_base::push(header_const_ptr_list_const_ptr headers,
+    size_t first_height)
 {
     code ec;
 
@@ -266,7 +424,7 @@ code data_base::push(const chain::header& header, size_t height)
     ///////////////////////////////////////////////////////////////////////////
     unique_lock lock(write_mutex_);
 
-    if ((ec = verify_push(header, height)))
+    if ((ec = verify_push(*headers, first_height)))
         return ec;
 
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
@@ -274,7 +432,7 @@ code data_base::push(const chain::header& header, size_t height)
         return error::store_lock_failure;
 
     // State is indexed | pent (pending download).
-    blocks_->push(header, height);
+    blocks_->push(*headers, first_height);
     blocks_->commit();
 
     return end_write() ? error::success : error::store_lock_failure;
@@ -324,7 +482,7 @@ code data_base::pop(chain::header& out_header, size_t height)
 
 // Add transactions for an existing block header.
 // This assumes the txs do not exist, which is ok for IBD, but not catch-up.
-// This allows parallel write when write flushing is not enabled.
+// This allows parallel write when neither flushing nor logging writes.
 // TODO: optimize for catch-up sync by updating existing transactions.
 code data_base::update(block_const_ptr block, size_t height)
 {
@@ -332,16 +490,24 @@ code data_base::update(block_const_ptr block, size_t height)
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    conditional_lock lock(flush_each_write());
+    // A conditional_lock would lock a mutex of its own, serializing nothing.
+    unique_lock lock(write_mutex_, boost::defer_lock);
+
+    // Write flushing and write logging require that no other write sequence
+    // overlap an update, so updates are then serialized with all writers.
+    if (flush_each_write() || log_each_write())
+        lock.lock();
 
     if ((ec = verify_update(*block, height)))
         return ec;
 
-    // Conditional write mutex preserves write flushing by preventing overlap.
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
+    // Rows of unconfirmed transactions are not journaled.
+    short_hash_list rows;
+
     for (const auto& tx: block->transactions())
     {
         // This stores the transaction and sets tx link metadata.
@@ -354,10 +520,10 @@ code data_base::update(block_const_ptr block, size_t height)
         // With validation we have prevouts and can control order, though not
         // as fast and requires full validation (for all prevouts) or short
         // validation (checkpoint/milestone) population of prevouts.
-        if (settings_.index_addresses)
+        if (index_inline())
         {
-            push_inputs(tx);
-            push_outputs(tx);
+            push_inputs(tx, height, rows);
+            push_outputs(tx, height, rows);
         }
     }
 
@@ -370,6 +536,49 @@ code data_base::update(block_const_ptr block, size_t height)
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// private
+// Requests are verified and stored in queue order, so a duplicate of a
+// preceding request of the group is rejected as it would be if not grouped.
+void data_base::store_pooled(const pool_requests& requests)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+    {
+        for (const auto request: requests)
+            request->result = error::store_lock_failure;
+
+        return;
+    }
+
+    for (const auto request: requests)
+    {
+        // Returns error::unspent_duplicate if an unspent tx with same hash
+        // exists.
+        if ((request->result = verify_push(request->tx)))
+            continue;
+
+        // When position is unconfirmed, height is used to store validation
+        // forks.
+        transactions_->store(request->tx, request->forks, no_time,
+            unconfirmed, pool);
+    }
+
+    transactions_->commit();
+
+    if (end_write())
+        return;
+
+    for (const auto request: requests)
+        if (!request->result)
+            request->result = error::store_lock_failure;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 // private
 // Store, update, validate and confirm the genesis block.
 code data_base::push_genesis(const block& block)
@@ -388,9 +597,14 @@ code data_base::push_genesis(const block& block)
         return error::store_lock_failure;
 
     // Pushes transactions sequentially as **confirmed**.
-    if ((ec = push_transactions(block, genesis_height, no_time)))
+    short_hash_list rows;
+    if ((ec = push_transactions(block, genesis_height, no_time, rows)) ||
+        (ec = push_journal(block, genesis_height, rows)))
         return ec;
 
+    if (index_inline())
+        addresses_->set_indexed(genesis_height + 1u);
+
     // Populate pent block's transaction references.
     blocks_->update(block);
 
@@ -492,6 +706,28 @@ code data_base::verify_push(const header& header, size_t height) const
     return error::success;
 }
 
+// The first header is verified against the store, each other against the
+// header that precedes it in the list.
+code data_base::verify_push(const message::header::const_ptr_list& headers,
+    size_t first_height) const
+{
+    code ec;
+
+    if (headers.empty())
+        return error::success;
+
+    if ((ec = verify_push(*headers.front(), first_height)))
+        return ec;
+
+#ifndef NDEBUG
+    for (auto it = std::next(headers.begin()); it != headers.end(); ++it)
+        if ((*it)->previous_block_hash() != (*std::prev(it))->hash())
+            return error::store_block_missing_parent;
+#endif
+
+    return error::success;
+}
+
 code data_base::verify_push(const block& block, size_t height) const
 {
     if (block.transactions().empty())
@@ -528,8 +764,8 @@ code data_base::verify_update(const block& block, size_t height) const
 
 // To push in order call with bucket = 0 and buckets = 1 (defaults).
 code data_base::push_transactions(const block& block, size_t height,
-    uint32_t median_time_past, size_t bucket, size_t buckets,
-    transaction_state state)
+    uint32_t median_time_past, short_hash_list& out_rows, size_t bucket,
+    size_t buckets, transaction_state state)
 {
     BITCOIN_ASSERT(bucket < buckets);
     const auto& txs = block.transactions();
@@ -544,18 +780,134 @@ code data_base::push_transactions(const block& block, size_t height,
         if (!transactions_->store(tx, height, median_time_past, position))
             return error::operation_failed;
 
-        if (settings_.index_addresses)
+        if (index_inline())
         {
-            push_inputs(tx);
-            push_outputs(tx);
+            push_inputs(tx, height, out_rows);
+            push_outputs(tx, height, out_rows);
         }
     }
 
     return error::success;
 }
 
-// TODO: add segwit address indexing.
-void data_base::push_inputs(const transaction& tx)
+// Journal the previous outputs and address rows of the confirmed block.
+// The spender of each journaled previous output is indexed if configured.
+code data_base::push_journal(const block& block, size_t height,
+    const short_hash_list& rows)
+{
+    undo_database::spend_list spends;
+
+    for (const auto& tx: block.transactions())
+    {
+        if (tx.is_coinbase())
+            continue;
+
+        uint32_t index = 0;
+
+        for (const auto& input: tx.inputs())
+        {
+            const auto& prevout = input.previous_output();
+            const auto result = transactions_->get(prevout.hash());
+            const spender_database::point inpoint{ tx.metadata.link, index++ };
+
+            // Missing previous outputs are not spent, so not journaled.
+            if (!result)
+                continue;
+
+            spends.emplace_back(result.link(), prevout.index());
+
+            if (settings_.index_spends)
+                spenders_->store(spends.back(), inpoint);
+        }
+    }
+
+    // Rows not indexed at confirmation are extracted again if popped.
+    const auto stored = index_inline() ? undos_->store(spends, rows, height) :
+        undos_->store(spends, height);
+
+    return stored ? error::success : error::operation_failed;
+}
+
+void data_base::push_inputs(const transaction& tx, size_t height,
+    short_hash_list& out_rows)
+{
+    address_rows rows;
+    input_rows(rows, tx);
+    store_rows(rows, height);
+
+    for (const auto& row: rows)
+        out_rows.push_back(row.key);
+}
+
+void data_base::push_outputs(const transaction& tx, size_t height,
+    short_hash_list& out_rows)
+{
+    address_rows rows;
+    output_rows(rows, tx);
+    store_rows(rows, height);
+
+    for (const auto& row: rows)
+        out_rows.push_back(row.key);
+}
+
+// To pop in order call with bucket = 0 and buckets = 1 (defaults).
+code data_base::pop_transactions(const block& block, size_t bucket,
+    size_t buckets)
+{
+    BITCOIN_ASSERT(bucket < buckets);
+    const auto& txs = block.transactions();
+    const auto count = txs.size();
+
+    for (auto position = bucket; position < count;
+        position = ceiling_add(position, buckets))
+    {
+        const auto& tx = txs[position];
+
+        if (!transactions_->unconfirm(tx.metadata.link))
+            return error::operation_failed;
+    }
+
+    return error::success;
+}
+
+// Replay the journal of the confirmed block, in reverse of its effects.
+code data_base::pop_journal(const block_result& result, size_t height)
+{
+    undo_database::spend_list spends;
+    short_hash_list rows;
+
+    if (!undos_->get(spends, rows, height))
+        return error::not_found;
+
+    for (const auto& spend: spends)
+        if (!transactions_->unspend(spend.first, spend.second))
+            return error::operation_failed;
+
+    if (settings_.index_spends)
+        for (const auto& spend: spends)
+            if (!spenders_->unlink(spend))
+                return error::operation_failed;
+
+    if (settings_.index_addresses)
+        for (auto row = rows.rbegin(); row != rows.rend(); ++row)
+            if (!addresses_->pop(*row))
+                return error::operation_failed;
+
+    for (const auto link: result)
+        if (!transactions_->demote(link))
+            return error::operation_failed;
+
+    return undos_->pop(height) ? error::success : error::operation_failed;
+}
+
+// Address rows.
+// ----------------------------------------------------------------------------
+// private
+
+// Witness and script hash spends are indexed only when the previous output
+// is cached.
+void data_base::input_rows(address_rows& out_rows,
+    const transaction& tx) const
 {
     if (tx.is_coinbase())
         return;
@@ -573,8 +925,20 @@ void data_base::push_inputs(const transaction& tx)
         {
             // This results in a complete and unambiguous history for the
             // address since standard outputs contain unambiguous address data.
+            const auto value = prevout.metadata.cache.value();
+
             for (const auto& address: prevout.metadata.cache.addresses())
-                addresses_->store(address.hash(), in);
+                out_rows.push_back({ address.hash(), in, value });
+
+            short_hash key;
+
+            if (address_database::to_key(key,
+                prevout.metadata.cache.script()))
+                out_rows.push_back({ key, in, value });
+
+            if (settings_.index_script_hashes)
+                out_rows.push_back({ address_database::to_script_key(
+                    prevout.metadata.cache.script()), in, value });
         }
         else
         {
@@ -582,14 +946,15 @@ void data_base::push_inputs(const transaction& tx)
             // For any p2kh spend this creates the ambiguous p2sh address,
             // which significantly expands the size of the history store.
             // These are tradeoffs when no prevout is cached (checkpoint sync).
+            // The spent value is not known here, so it is not summarized.
             for (const auto& address: input.addresses())
-                addresses_->store(address.hash(), in);
+                out_rows.push_back({ address.hash(), in, 0 });
         }
     }
 }
 
-// TODO: add segwit address indexing.
-void data_base::push_outputs(const transaction& tx)
+void data_base::output_rows(address_rows& out_rows,
+    const transaction& tx) const
 {
     uint32_t index = 0;
     const auto& outputs = tx.outputs();
@@ -597,129 +962,438 @@ void data_base::push_outputs(const transaction& tx)
 
     for (const auto& output: outputs)
     {
-        const payment_record out{ link, index++, output.value(), true };
+        const auto value = output.value();
+        const payment_record out{ link, index++, value, true };
 
         // Standard outputs contain unambiguous address data.
         for (const auto& address: output.addresses())
-            addresses_->store(address.hash(), out);
+            out_rows.push_back({ address.hash(), out, value });
+
+        // Witness outputs are keyed by their program and its type.
+        short_hash key;
+
+        if (address_database::to_key(key, output.script()))
+            out_rows.push_back({ key, out, value });
+
+        // Any output script is keyed by its hash, including non-standard.
+        if (settings_.index_script_hashes)
+            out_rows.push_back({ address_database::to_script_key(
+                output.script()), out, value });
     }
 }
 
-// To pop in order call with bucket = 0 and buckets = 1 (defaults).
-code data_base::pop_transactions(const block& block, size_t bucket,
-    size_t buckets)
+void data_base::store_rows(const address_rows& rows, size_t height)
+{
+    for (const auto& row: rows)
+        addresses_->store(row.key, row.payment, height, row.value);
+}
+
+bool data_base::index_inline() const
+{
+    return settings_.index_addresses && !deferred_ &&
+        settings_.address_index_threads == 0;
+}
+
+bool data_base::index_async() const
+{
+    return settings_.index_addresses && !deferred_ &&
+        settings_.address_index_threads != 0;
+}
+
+// Asynchronous address indexing.
+// ----------------------------------------------------------------------------
+// private
+
+// Confirmed blocks are indexed in height order on the indexer thread, which
+// advances the indexed height watermark of the address database. Block
+// writes do not wait on indexing, and address queries may lag block queries.
+void data_base::start_indexer()
+{
+    indexer_stopped_ = false;
+    indexer_pending_ = true;
+    indexer_ = std::thread(&data_base::do_index, this);
+}
+
+void data_base::stop_indexer()
+{
+    if (!indexer_.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(indexer_mutex_);
+        indexer_stopped_ = true;
+    }
+
+    indexer_condition_.notify_one();
+    indexer_.join();
+}
+
+void data_base::notify_indexer()
+{
+    if (!index_async())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(indexer_mutex_);
+        indexer_pending_ = true;
+    }
+
+    indexer_condition_.notify_one();
+}
+
+void data_base::do_index()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(indexer_mutex_);
+            indexer_condition_.wait(lock, [this]()
+            {
+                return indexer_stopped_ || indexer_pending_;
+            });
+
+            if (indexer_stopped_)
+                return;
+
+            indexer_pending_ = false;
+        }
+
+        // Index until caught up with the block index, failed or stopped.
+        while (!indexer_stopped_ && index_next());
+    }
+}
+
+// Index the block above the watermark, false if none or indexing failed.
+bool data_base::index_next()
+{
+    const auto height = addresses_->indexed();
+    const auto result = blocks_->get(height, true);
+
+    if (!result)
+        return false;
+
+    // Rows are extracted without locks, each bucket on its own thread.
+    const auto hash = result.hash();
+    const auto txs = to_transactions(result);
+    const auto threads = static_cast<size_t>(settings_.address_index_threads);
+    const auto buckets = std::max<size_t>(std::min(threads, txs.size()), 1);
+    std::vector<address_rows> rows(txs.size());
+    std::vector<std::thread> workers;
+    workers.reserve(buckets - 1u);
+
+    for (size_t bucket = 1; bucket < buckets; ++bucket)
+        workers.emplace_back(&data_base::index_transactions, this,
+            std::ref(rows), std::cref(txs), height, bucket, buckets);
+
+    index_transactions(rows, txs, height, 0, buckets);
+
+    for (auto& worker: workers)
+        worker.join();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    // Storage is serialized with other writers (lock order as for bulk).
+    unique_lock lock(write_mutex_);
+    unique_lock index_lock(index_mutex_);
+
+    // The block may have been popped or bulk indexed during extraction.
+    const auto current = blocks_->get(height, true);
+
+    if (!current || current.hash() != hash || addresses_->indexed() != height)
+        return true;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+    {
+        LOG_ERROR(LOG_DATABASE)
+            << "Failure locking store for address indexing.";
+        return false;
+    }
+
+    // Rows are stored in the order of their transactions.
+    for (const auto& tx_rows: rows)
+        store_rows(tx_rows, height);
+
+    addresses_->set_indexed(height + 1u);
+    addresses_->commit();
+
+    if (!end_write())
+    {
+        LOG_ERROR(LOG_DATABASE)
+            << "Failure unlocking store for address indexing.";
+        return false;
+    }
+
+    return true;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Previous outputs of the block are populated as of its height, so that the
+// rows of a block are the same when extracted for indexing and for its pop.
+void data_base::index_transactions(std::vector<address_rows>& out_rows,
+    const transaction::list& txs, size_t height, size_t bucket,
+    size_t buckets) const
 {
     BITCOIN_ASSERT(bucket < buckets);
-    const auto& txs = block.transactions();
     const auto count = txs.size();
 
     for (auto position = bucket; position < count;
         position = ceiling_add(position, buckets))
     {
         const auto& tx = txs[position];
+        auto& rows = out_rows[position];
 
-        if (!transactions_->unconfirm(tx.metadata.link))
-            return error::operation_failed;
+        if (!tx.is_coinbase())
+            for (const auto& input: tx.inputs())
+                transactions_->get_output(input.previous_output(), height);
+
+        input_rows(rows, tx);
+        output_rows(rows, tx);
+    }
+}
+
+// Must be called under write and index locks and within a begin/end write.
+code data_base::unindex(const block& block, size_t height)
+{
+    const auto& txs = block.transactions();
+    std::vector<address_rows> rows(txs.size());
+    index_transactions(rows, txs, height, 0, 1);
 
-        if (settings_.index_addresses)
-            if (!pop_inputs(tx) || !pop_outputs(tx))
+    for (auto tx = rows.rbegin(); tx != rows.rend(); ++tx)
+        for (auto row = tx->rbegin(); row != tx->rend(); ++row)
+            if (!addresses_->pop(row->key))
                 return error::operation_failed;
+
+    addresses_->set_indexed(height);
+    addresses_->commit();
+    return error::success;
+}
+
+// Deferred bulk address indexing.
+// ----------------------------------------------------------------------------
+
+// The number of blocks of which rows are extracted, sorted and stored at once.
+static constexpr size_t bulk_blocks = 1000;
+
+// Rows are extracted in parallel and sorted by key so that each history of a
+// batch is written contiguously, instead of being appended block by block.
+code data_base::build_address_index()
+{
+    code ec;
+
+    if (!settings_.index_addresses)
+        return error::operation_failed;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+    unique_lock index_lock(index_mutex_);
+
+    size_t top;
+    const auto count = blocks_->top(top, true) ? top + 1u : 0u;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    for (auto first = addresses_->indexed(); first < count;)
+    {
+        const auto last = first + std::min(bulk_blocks, count - first);
+
+        if ((ec = index_batch(first, last)))
+            return ec;
+
+        // Each batch is committed, so that a failed build may be resumed.
+        addresses_->set_indexed(last);
+        addresses_->commit();
+        first = last;
     }
 
+    deferred_ = false;
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (index_async() && !indexer_.joinable())
+        start_indexer();
+
     return error::success;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
 }
 
-bool data_base::pop_inputs(const chain::transaction& tx)
+// private
+size_t data_base::extraction_threads() const
 {
-    if (!settings_.index_addresses || tx.is_coinbase())
-        return true;
+    const auto threads = settings_.address_index_threads != 0 ?
+        settings_.address_index_threads : std::thread::hardware_concurrency();
 
-    for (auto input: tx.inputs())
-        for (const auto& address: input.addresses())
-            if (!addresses_->pop(address.hash()))
-                return false;
+    return std::max<size_t>(threads, 1);
+}
 
-    return true;
+// private
+// Must be called under write and index locks and within a begin/end write.
+code data_base::index_batch(size_t first, size_t last)
+{
+    BITCOIN_ASSERT(first < last);
+    const auto blocks = last - first;
+    const auto buckets = std::min(extraction_threads(), blocks);
+    std::vector<std::vector<address_rows>> rows(blocks);
+    std::vector<std::thread> workers;
+    workers.reserve(buckets - 1u);
+
+    for (size_t bucket = 1; bucket < buckets; ++bucket)
+        workers.emplace_back(&data_base::extract_blocks, this, std::ref(rows),
+            first, bucket, buckets);
+
+    extract_blocks(rows, first, 0, buckets);
+
+    for (auto& worker: workers)
+        worker.join();
+
+    // Rows are ordered by height and position, which the sort preserves.
+    typedef std::pair<size_t, const address_row*> sort_row;
+    std::vector<sort_row> sorted;
+
+    for (size_t block = 0; block < blocks; ++block)
+        for (const auto& tx_rows: rows[block])
+            for (const auto& row: tx_rows)
+                sorted.emplace_back(first + block, &row);
+
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const sort_row& left, const sort_row& right)
+        {
+            return left.second->key < right.second->key;
+        });
+
+    address_database::row_list history;
+
+    for (auto row = sorted.begin(); row != sorted.end();)
+    {
+        const auto& key = row->second->key;
+        history.clear();
+
+        for (; row != sorted.end() && row->second->key == key; ++row)
+            history.push_back({ row->second->payment, row->first,
+                row->second->value });
+
+        addresses_->store(key, history);
+    }
+
+    return error::success;
 }
 
-bool data_base::pop_outputs(const chain::transaction& tx)
+// private
+void data_base::extract_blocks(
+    std::vector<std::vector<address_rows>>& out_rows, size_t first,
+    size_t bucket, size_t buckets) const
 {
-    if (!settings_.index_addresses)
-        return true;
+    BITCOIN_ASSERT(bucket < buckets);
+    const auto count = out_rows.size();
 
-    for (auto output: tx.outputs())
-        for (const auto& address: output.addresses())
-            if (!addresses_->pop(address.hash()))
-                return false;
+    for (auto block = bucket; block < count;
+        block = ceiling_add(block, buckets))
+    {
+        const auto height = first + block;
+        const auto result = blocks_->get(height, true);
+        BITCOIN_ASSERT(result);
 
-    return true;
+        const auto txs = to_transactions(result);
+        out_rows[block].resize(txs.size());
+        index_transactions(out_rows[block], txs, height, 0, 1);
+    }
 }
 
 // Header reorganization.
 // ----------------------------------------------------------------------------
 
+// The full reorganization is applied under one lock, commit and flush.
 code data_base::reorganize(const config::checkpoint& fork_point,
     header_const_ptr_list_const_ptr incoming,
     header_const_ptr_list_ptr outgoing)
 {
+    code ec;
+
     if (fork_point.height() > max_size_t - incoming->size())
         return error::operation_failed;
 
-    const auto result =
-        pop_above(outgoing, fork_point) &&
-        push_all(incoming, fork_point);
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    if ((ec = pop_above(outgoing, fork_point)) ||
+        (ec = push_all(incoming, fork_point)))
+        return ec;
 
-    return result ? error::success : error::operation_failed;
+    blocks_->commit();
+
+    return end_write() ? error::success : error::store_lock_failure;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 // private
-bool data_base::pop_above(header_const_ptr_list_ptr headers,
+// Must be called under write lock and within a begin/end write.
+code data_base::pop_above(header_const_ptr_list_ptr headers,
     const config::checkpoint& fork_point)
 {
     code ec;
     headers->clear();
     if ((ec = verify(fork_point, false)))
-        return false;
+        return ec;
 
     size_t top;
     if (!blocks_->top(top, false))
-        return false;
+        return error::operation_failed;
 
     const auto fork = fork_point.height();
     const auto depth = top - fork;
-    headers->reserve(depth);
+    headers->resize(depth);
     if (depth == 0)
-        return true;
+        return error::success;
 
-    // Pop all headers above the fork point.
+    // Pop all headers above the fork point, filling the list from the back.
     for (size_t height = top; height > fork; --height)
     {
-        const auto next = std::make_shared<message::header>();
-        if ((ec = pop(*next, height)))
-            return false;
+        const auto result = blocks_->get(height, false);
+
+        if (!result)
+            return error::operation_failed;
+
+        const auto header = std::make_shared<message::header>(result.header());
+        BITCOIN_ASSERT(header->is_valid());
+
+        if (!blocks_->unconfirm(result.hash(), height, false))
+            return error::operation_failed;
 
-        headers->insert(headers->begin(), next);
+        (*headers)[height - fork - 1] = header;
     }
 
-    return true;
+    return error::success;
 }
 
 // private
-bool data_base::push_all(header_const_ptr_list_const_ptr headers,
+// Must be called under write lock and within a begin/end write.
+code data_base::push_all(header_const_ptr_list_const_ptr headers,
     const config::checkpoint& fork_point)
 {
     code ec;
     const auto first_height = fork_point.height() + 1;
 
-    // Push all headers onto the fork point.
-    for (size_t index = 0; index < headers->size(); ++index)
-    {
-        const auto next = (*headers)[index];
-        if ((ec = push(*next, first_height + index)))
-            return false;
-    }
+    if (headers->empty())
+        return error::success;
 
-    return true;
+    if ((ec = verify_push(*headers, first_height)))
+        return ec;
+
+    // Push all headers onto the fork point.
+    blocks_->push(*headers, first_height);
+    return error::success;
 }
 
 // Utility writers.
@@ -746,13 +1420,22 @@ code data_base::push(const block& block, size_t height,
         return error::store_lock_failure;
 
     // Pushes transactions sequentially as confirmed.
-    if ((ec = push_transactions(block, height, median_time_past)))
+    short_hash_list rows;
+    if ((ec = push_transactions(block, height, median_time_past, rows)) ||
+        (ec = push_journal(block, height, rows)))
         return ec;
 
+    if (index_inline())
+        addresses_->set_indexed(height + 1u);
+
     blocks_->push(block, height, median_time_past);
     commit();
 
-    return end_write() ? error::success : error::store_lock_failure;
+    if (!end_write())
+        return error::store_lock_failure;
+
+    notify_indexer();
+    return error::success;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
@@ -777,13 +1460,35 @@ code data_base::pop(chain::block& out_block, size_t height)
     // Create a block for walking transactions and return.
     out_block = chain::block(result.header(), to_transactions(result));
 
+    // The indexer cannot store rows of the block while it is popped.
+    unique_lock index_lock(index_mutex_);
+
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
-    if ((ec = pop_transactions(out_block)))
+    // Rows indexed asynchronously, in bulk or before journaling are not
+    // journaled, so are extracted again for the pop.
+    if (settings_.index_addresses && addresses_->indexed() > height &&
+        !undos_->has_rows(height) && (ec = unindex(out_block, height)))
         return ec;
 
+    // Blocks confirmed without a journal are popped by their transactions,
+    // and the skipped height (if any) is removed from the journal index.
+    if ((ec = pop_journal(result, height)) == error::not_found)
+    {
+        ec = pop_transactions(out_block);
+
+        if (!ec && !undos_->pop(height))
+            ec = error::operation_failed;
+    }
+
+    if (ec)
+        return ec;
+
+    if (index_inline())
+        addresses_->set_indexed(height);
+
     if (!blocks_->unconfirm(out_block.hash(), height, true))
         return error::operation_failed;
 
@@ -18,45 +18,105 @@
  */
 #include <bitcoin/database/databases/address_database.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
-#include <tuple>
-#include <utility>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/memory/memory.hpp>
-#include <bitcoin/database/primitives/hash_table_multimap.hpp>
+#include "address_page.hpp"
 
-// Record format (v4/v3) [47 bytes, 71 with key/link]:
+// Root value format [36 bytes]:
 // ----------------------------------------------------------------------------
-// [ kind:1        - const]
-// [ point-hash:32 - const]
-// [ point-index:2 - const]
-// [ height:4      - const]
-// [ checksum:8    - const]
+// [ page:8         - atomic1] (newest page)
+// [ received:8     - atomic1]
+// [ spent:8        - atomic1]
+// [ rows:4         - atomic1]
+// [ first_height:4 - atomic1]
+// [ last_height:4  - atomic1]
+//
+// Page file header format [8 bytes]:
+// ----------------------------------------------------------------------------
+// [ indexed:8      - atomic1] (count of indexed blocks of the block index)
+//
+// The page and row formats are shared with the iterator (address_page.hpp).
 
 namespace libbitcoin {
 namespace database {
 
 using namespace bc::chain;
+using namespace bc::machine;
+
+static constexpr auto satoshi_size = sizeof(uint64_t);
+static constexpr auto indexed_size = sizeof(uint64_t);
+static constexpr auto root_size = sizeof(file_offset) + 2 * satoshi_size +
+    3 * sizeof(uint32_t);
+
+// Unused row slots of a page are sized for this, most rows are smaller.
+static constexpr size_t expected_row_size = 16;
+
+// Cursors are the page link and the row position (from oldest) within it.
+static constexpr auto cursor_row_bits = 6u;
+static constexpr auto cursor_row_mask = (1u << cursor_row_bits) - 1u;
+
+// Pages double in capacity, so sparse histories do not reserve full pages.
+static constexpr size_t first_capacity = 2;
+
+const size_t address_database::page_capacity = 32;
+const address_database::cursor address_database::first_cursor = max_uint64;
+const address_database::cursor address_database::last_cursor =
+    max_uint64 - 1u;
+
+static file_offset read_summary(byte_deserializer& deserial,
+    address_database::summary& out_summary)
+{
+    const auto page = deserial.read_8_bytes_little_endian();
+    out_summary.received = deserial.read_8_bytes_little_endian();
+    out_summary.spent = deserial.read_8_bytes_little_endian();
+    out_summary.rows = deserial.read_4_bytes_little_endian();
+    out_summary.first_height = deserial.read_4_bytes_little_endian();
+    out_summary.last_height = deserial.read_4_bytes_little_endian();
+    return page;
+}
+
+static void write_summary(byte_serializer& serial, file_offset page,
+    const address_database::summary& summary)
+{
+    BITCOIN_ASSERT(summary.rows <= max_uint32);
+    serial.write_8_bytes_little_endian(page);
+    serial.write_8_bytes_little_endian(summary.received);
+    serial.write_8_bytes_little_endian(summary.spent);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(summary.rows));
+    serial.write_4_bytes_little_endian(
+        static_cast<uint32_t>(summary.first_height));
+    serial.write_4_bytes_little_endian(
+        static_cast<uint32_t>(summary.last_height));
+}
+
+static void summarize(address_database::summary& totals,
+    const address_database::row& row)
+{
+    if (row.payment.is_output())
+        totals.received = ceiling_add(totals.received, row.value);
+    else
+        totals.spent = ceiling_add(totals.spent, row.value);
+
+    if (totals.rows++ == 0)
+        totals.first_height = row.height;
 
-// Total size of address storage (using tx link vs. hash for point).
-static const auto value_size = payment_record::satoshi_fixed_size(false);
+    totals.last_height = row.height;
+}
 
 // History uses a hash table index, O(1).
-// The hash table stores indexes to the first element of unkeyed linked lists.
+// The hash table stores links to the newest page of each history.
 address_database::address_database(const path& lookup_filename,
     const path& rows_filename, size_t buckets, size_t expansion)
   : hash_table_file_(lookup_filename, expansion),
+    hash_table_(hash_table_file_, buckets, root_size),
 
-    // THIS sizeof(link_type) IS ASSUMED BY hash_table_multimap.
-    hash_table_(hash_table_file_, buckets, sizeof(link_type)),
-
-    // Linked-list storage for multimap.
+    // Slab storage for history pages.
     address_index_file_(rows_filename, expansion),
-    address_index_(address_index_file_, 0,
-        hash_table_multimap<key_type, index_type, link_type>::size(value_size)),
-
-    address_multimap_(hash_table_, address_index_)
+    address_index_(address_index_file_, indexed_size),
+    indexed_(0)
 {
 }
 
@@ -75,22 +135,36 @@ bool address_database::create()
         return false;
 
     // No need to call open after create.
-    return
+    const auto created =
         hash_table_.create() &&
         address_index_.create();
+
+    if (created)
+    {
+        indexed_ = 0;
+        write_indexed();
+    }
+
+    return created;
 }
 
 bool address_database::open()
 {
-    return
+    const auto opened =
         hash_table_file_.open() &&
         address_index_file_.open() &&
         hash_table_.start() &&
         address_index_.start();
+
+    if (opened)
+        read_indexed();
+
+    return opened;
 }
 
 void address_database::commit()
 {
+    write_indexed();
     hash_table_.commit();
     address_index_.commit();
 }
@@ -109,37 +183,458 @@ bool address_database::close()
         address_index_file_.close();
 }
 
+bool address_database::attach(write_log& log)
+{
+    return
+        log.attach(hash_table_file_) &&
+        log.attach(address_index_file_);
+}
+
+// Keys.
+// ----------------------------------------------------------------------------
+
+short_hash address_database::to_key(address_type type, data_slice program)
+{
+    BITCOIN_ASSERT(type != address_type::payment_address);
+    const auto prefix = to_array(static_cast<uint8_t>(type));
+    return bitcoin_short_hash(build_chunk({ prefix, program }));
+}
+
+// A witness program is a version push followed by a single program push.
+bool address_database::to_key(short_hash& out_key, const script& script)
+{
+    const auto& ops = script.operations();
+
+    if (ops.size() != 2)
+        return false;
+
+    const auto& program = ops[1].data();
+    const auto version = ops[0].code();
+    const auto size = program.size();
+
+    // The program must be a direct push, as required of witness outputs.
+    if (ops[1].code() != static_cast<opcode>(size))
+        return false;
+
+    if (version == opcode::push_size_0 && size == short_hash_size)
+        out_key = to_key(address_type::witness_key_hash, program);
+    else if (version == opcode::push_size_0 && size == hash_size)
+        out_key = to_key(address_type::witness_script_hash, program);
+    else if (version == opcode::push_positive_1 && size == hash_size)
+        out_key = to_key(address_type::witness_taproot, program);
+    else
+        return false;
+
+    return true;
+}
+
+short_hash address_database::to_script_key(const hash_digest& script_hash)
+{
+    return to_key(address_type::script_hash, script_hash);
+}
+
+short_hash address_database::to_script_key(const script& script)
+{
+    return to_script_key(sha256_hash(script.to_data(false)));
+}
+
 // Queries.
 // ----------------------------------------------------------------------------
 
 address_result address_database::get(const short_hash& hash) const
 {
-    return { address_multimap_.find(hash), hash };
+    return { address_index_, mutex_, read_root(hash), hash };
+}
+
+address_database::payment_list address_database::get(const short_hash& hash,
+    size_t from_height, size_t to_height, size_t limit, cursor& cursor) const
+{
+    BITCOIN_ASSERT(page_capacity <= cursor_row_mask);
+    payment_list payments;
+
+    if (cursor == last_cursor || limit == 0 || from_height > to_height)
+        return payments;
+
+    // The next row position within the page, clamped to the page count.
+    auto position = page_capacity;
+    auto page = page_manager::not_allocated;
+
+    if (cursor == first_cursor)
+    {
+        page = read_root(hash);
+    }
+    else
+    {
+        page = cursor >> cursor_row_bits;
+        position = cursor & cursor_row_mask;
+    }
+
+    while (page != page_manager::not_allocated)
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(mutex_);
+
+        const auto memory = address_index_.get(page);
+        const auto buffer = memory->buffer();
+        const auto next = read_next(buffer);
+        const auto bounds = buffer + bounds_offset;
+        const size_t min_height = from_little_endian_unsafe<uint32_t>(bounds);
+        const size_t max_height = from_little_endian_unsafe<uint32_t>(
+            bounds + height_size);
+
+        // Pages are appended in block order, so once a page is below the
+        // height range so is every older page, and the walk is complete.
+        if (max_height < from_height)
+            break;
+
+        // Pass over a page above the height range without reading its rows.
+        if (min_height > to_height)
+        {
+            page = next;
+            position = page_capacity;
+            continue;
+        }
+
+        // Rows are delta encoded, so the page is read in full.
+        const auto rows = read_page(buffer);
+        position = std::min(position, rows.size());
+
+        while (position > 0)
+        {
+            if (payments.size() == limit)
+            {
+                cursor = (page << cursor_row_bits) | position;
+                return payments;
+            }
+
+            const auto& row = rows[--position];
+
+            if (row.height >= from_height && row.height <= to_height)
+                payments.push_back(row.payment);
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        page = next;
+        position = page_capacity;
+    }
+
+    cursor = last_cursor;
+    return payments;
+}
+
+bool address_database::get_summary(summary& out_summary,
+    const short_hash& hash) const
+{
+    const auto root = hash_table_.find(hash);
+
+    if (!root)
+        return false;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(mutex_);
+        read_summary(deserial, out_summary);
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    root.read(reader);
+    return true;
+}
+
+size_t address_database::indexed() const
+{
+    return indexed_;
 }
 
 // Store.
 // ----------------------------------------------------------------------------
 
 void address_database::store(const short_hash& hash,
-    const payment_record& payment)
+    const payment_record& payment, size_t height, uint64_t value)
+{
+    const row single{ payment, height, value };
+    store(hash, &single, &single + 1);
+}
+
+void address_database::store(const short_hash& hash, const row_list& rows)
 {
+    store(hash, rows.data(), rows.data() + rows.size());
+}
+
+// private
+// New pages grow geometrically from the head page, or are sized to the rows.
+void address_database::store(const short_hash& hash, const row* first,
+    const row* last)
+{
+    if (first == last)
+        return;
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto root = hash_table_.find(hash);
+    auto head = page_manager::not_allocated;
+    summary totals{ 0, 0, 0, 0, 0 };
+
+    if (root)
+    {
+        const auto reader = [&](byte_deserializer& deserial)
+        {
+            // This could be a terminator if previously unlinked.
+            head = read_summary(deserial, totals);
+        };
+
+        root.read(reader);
+    }
+
+    for (auto it = first; it != last; ++it)
+        summarize(totals, *it);
+
+    auto capacity = first_capacity;
+
+    if (head != page_manager::not_allocated)
+    {
+        // The memory object must be released before a page is allocated.
+        const auto memory = address_index_.get(head);
+        const auto buffer = memory->buffer();
+        const auto rows = read_page(buffer);
+        uint64_t height = rows.empty() ? 0 : rows.back().height;
+        uint64_t link = rows.empty() ? 0 : rows.back().payment.link();
+        const size_t used = from_little_endian_unsafe<uint16_t>(buffer +
+            used_offset);
+
+        // Append rows to the newest page while it has space.
+        while (first != last && append_row(buffer, *first, height, link))
+            ++first;
+
+        const size_t appended = from_little_endian_unsafe<uint16_t>(buffer +
+            used_offset) - used;
+
+        if (appended != 0)
+        {
+            address_index_.log_write(buffer + count_offset,
+                rows_offset - count_offset);
+            address_index_.log_write(buffer + rows_offset + used, appended);
+        }
+
+        const size_t head_capacity = buffer[next_size];
+        capacity = std::min(2 * head_capacity, page_capacity);
+    }
+
+    while (first != last)
+    {
+        const size_t remaining = last - first;
+        const auto rows = std::min(remaining, page_capacity);
+        capacity = std::max(capacity, rows);
+
+        // The page is sized to its rows, and to expected rows for free slots.
+        uint64_t height = 0;
+        uint64_t link = 0;
+        auto size = (capacity - rows) * expected_row_size;
+
+        for (auto row = first; row != first + rows; ++row)
+        {
+            size += row_size(*row, height, link);
+            height = row->height;
+            link = row->payment.link();
+        }
+
+        head = allocate(head, capacity, size);
+
+        // The memory object must be released before a page is allocated.
+        const auto memory = address_index_.get(head);
+        const auto buffer = memory->buffer();
+        height = 0;
+        link = 0;
+
+        // The page is sized to the rows, so each append succeeds.
+        for (const auto end = first + rows; first != end; ++first)
+            append_row(buffer, *first, height, link);
+
+        capacity = std::min(2 * capacity, page_capacity);
+    }
+
     const auto writer = [&](byte_serializer& serial)
     {
-        payment.to_data(serial, false);
+        write_summary(serial, head, totals);
     };
 
-    // Write the new payment history.
-    auto next = address_multimap_.allocator();
-    next.create(writer);
-    address_multimap_.link(hash, next);
+    if (root)
+    {
+        root.write(writer);
+        root.log(0, root_size);
+        return;
+    }
+
+    auto next = hash_table_.allocator();
+    next.create(hash, writer);
+    hash_table_.link(next);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+address_database::page_type address_database::read_root(
+    const short_hash& hash) const
+{
+    auto page = page_manager::not_allocated;
+    const auto root = hash_table_.find(hash);
+
+    if (!root)
+        return page;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(mutex_);
+        page = deserial.read_8_bytes_little_endian();
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    root.read(reader);
+    return page;
+}
+
+// private
+// Page bounds start empty and are widened as rows are written.
+address_database::page_type address_database::allocate(page_type next,
+    size_t capacity, size_t size)
+{
+    BITCOIN_ASSERT(capacity <= page_capacity);
+    BITCOIN_ASSERT(size <= max_uint16);
+    const auto page = address_index_.allocate(rows_offset + size);
+
+    const auto memory = address_index_.get(page);
+    write_page(memory->buffer(), next, capacity, size);
+    return page;
 }
 
 // Update.
 // ----------------------------------------------------------------------------
 
+// Emptied pages are unlinked and not reclaimed, as with all slab storage.
+// Page height bounds are not narrowed, as they only need to contain the rows.
 bool address_database::pop(const short_hash& hash)
 {
-    return address_multimap_.unlink(hash);
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto root = hash_table_.find(hash);
+
+    // There is no root element, nothing to unlink.
+    if (!root)
+        return false;
+
+    page_type head;
+    summary totals;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        head = read_summary(deserial, totals);
+    };
+
+    root.read(reader);
+
+    // The root element is empty, nothing to unlink.
+    if (head == page_manager::not_allocated)
+        return false;
+
+    auto page = head;
+    size_t last_height = 0;
+
+    // The memory object must be released before the next page is read.
+    {
+        const auto memory = address_index_.get(head);
+        const auto buffer = memory->buffer();
+        const auto rows = read_page(buffer);
+        BITCOIN_ASSERT(!rows.empty());
+        const auto& row = rows.back();
+
+        // Totals saturate at store, so the subtraction cannot underflow.
+        if (row.payment.is_output())
+            totals.received -= row.value;
+        else
+            totals.spent -= row.value;
+
+        if (rows.size() > 1)
+        {
+            const auto& prior = rows[rows.size() - 2u];
+            const size_t used = from_little_endian_unsafe<uint16_t>(buffer +
+                used_offset);
+            const auto bytes = row_size(row, prior.height,
+                prior.payment.link());
+
+            auto serial = make_unsafe_serializer(buffer + count_offset);
+            serial.write_byte(static_cast<uint8_t>(rows.size() - 1u));
+            serial.skip(bytes_size);
+            serial.write_2_bytes_little_endian(static_cast<uint16_t>(used -
+                bytes));
+            address_index_.log_write(buffer + count_offset,
+                bounds_offset - count_offset);
+            last_height = prior.height;
+        }
+        else
+        {
+            page = read_next(buffer);
+        }
+    }
+
+    BITCOIN_ASSERT(totals.rows != 0);
+
+    if (--totals.rows == 0)
+    {
+        totals.first_height = 0;
+        totals.last_height = 0;
+    }
+    else if (page != head)
+    {
+        // The newest remaining row is the last row of the next page.
+        const auto memory = address_index_.get(page);
+        totals.last_height = read_page(memory->buffer()).back().height;
+    }
+    else
+    {
+        totals.last_height = last_height;
+    }
+
+    // This may leave an empty root element in place, but presumably that will
+    // become resused in the future as the transaction is re-confirmed.
+    const auto writer = [&](byte_serializer& serial)
+    {
+        write_summary(serial, page, totals);
+    };
+
+    root.write(writer);
+    root.log(0, root_size);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void address_database::set_indexed(size_t count)
+{
+    indexed_ = count;
+}
+
+// private
+void address_database::read_indexed()
+{
+    // The accessor must remain in scope until the end of the block.
+    const auto memory = address_index_file_.access();
+    indexed_ = from_little_endian_unsafe<uint64_t>(memory->buffer());
+}
+
+// private
+void address_database::write_indexed()
+{
+    // The accessor must remain in scope until the end of the block.
+    const auto memory = address_index_file_.access();
+    auto serial = make_unsafe_serializer(memory->buffer());
+    serial.write_8_bytes_little_endian(indexed_);
+    address_index_file_.log_write(memory->buffer(), sizeof(uint64_t));
 }
 
 } // namespace database
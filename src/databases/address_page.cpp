@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "address_page.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/databases/address_database.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::chain;
+
+// Row flags.
+static constexpr uint8_t output_flag = 1;
+static constexpr uint8_t implied_flag = 2;
+
+void write_page(uint8_t* page, file_offset next, size_t capacity,
+    size_t size)
+{
+    auto serial = make_unsafe_serializer(page);
+    serial.write_8_bytes_little_endian(next);
+    serial.write_byte(static_cast<uint8_t>(capacity));
+    serial.write_byte(0);
+    serial.write_2_bytes_little_endian(static_cast<uint16_t>(size));
+    serial.write_2_bytes_little_endian(0);
+    serial.write_4_bytes_little_endian(max_uint32);
+    serial.write_4_bytes_little_endian(0);
+}
+
+file_offset read_next(const uint8_t* page)
+{
+    return from_little_endian_unsafe<file_offset>(page);
+}
+
+// Deltas are signed, as histories are not required to be in height order.
+static uint64_t encode_delta(uint64_t value, uint64_t previous)
+{
+    const auto delta = value - previous;
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+static uint64_t decode_delta(uint64_t encoded, uint64_t previous)
+{
+    return previous + ((encoded >> 1) ^ (0 - (encoded & 1)));
+}
+
+// The size of the row encoded following a row of the height and link.
+size_t row_size(const address_database::row& row, uint64_t height,
+    uint64_t link)
+{
+    const auto& payment = row.payment;
+    const auto output = payment.is_output();
+    const auto implied = row.value == payment.data();
+
+    return sizeof(uint8_t) +
+        message::variable_uint_size(encode_delta(row.height, height)) +
+        message::variable_uint_size(encode_delta(payment.link(), link)) +
+        message::variable_uint_size(payment.index()) +
+        (output ? message::variable_uint_size(payment.data()) :
+            sizeof(uint64_t)) +
+        (implied ? 0u : message::variable_uint_size(row.value));
+}
+
+// Write the row following a row of the height and link, which are updated.
+void write_row(byte_serializer& serial,
+    const address_database::row& row, uint64_t& height, uint64_t& link)
+{
+    const auto& payment = row.payment;
+    const auto output = payment.is_output();
+    const auto implied = row.value == payment.data();
+
+    serial.write_byte((output ? output_flag : 0) |
+        (implied ? implied_flag : 0));
+    serial.write_variable_little_endian(encode_delta(row.height, height));
+    serial.write_variable_little_endian(encode_delta(payment.link(), link));
+    serial.write_variable_little_endian(payment.index());
+
+    if (output)
+        serial.write_variable_little_endian(payment.data());
+    else
+        serial.write_8_bytes_little_endian(payment.data());
+
+    if (!implied)
+        serial.write_variable_little_endian(row.value);
+
+    height = row.height;
+    link = payment.link();
+}
+
+// Read the row following a row of the height and link, which are updated.
+address_database::row read_row(byte_deserializer& deserial,
+    uint64_t& height, uint64_t& link)
+{
+    const auto flags = deserial.read_byte();
+    const auto output = (flags & output_flag) != 0;
+    height = decode_delta(deserial.read_variable_little_endian(), height);
+    link = decode_delta(deserial.read_variable_little_endian(), link);
+    const auto index = deserial.read_variable_little_endian();
+    const auto data = output ? deserial.read_variable_little_endian() :
+        deserial.read_8_bytes_little_endian();
+    const auto value = (flags & implied_flag) != 0 ? data :
+        deserial.read_variable_little_endian();
+
+    return
+    {
+        payment_record{ link, static_cast<uint32_t>(index), data, output },
+        static_cast<size_t>(height),
+        value
+    };
+}
+
+// Read the rows of the page, oldest first.
+address_database::row_list read_page(uint8_t* page)
+{
+    const size_t count = page[count_offset];
+    auto deserial = make_unsafe_deserializer(page + rows_offset);
+    uint64_t height = 0;
+    uint64_t link = 0;
+
+    address_database::row_list rows;
+    rows.reserve(count);
+
+    for (size_t row = 0; row < count; ++row)
+        rows.push_back(read_row(deserial, height, link));
+
+    return rows;
+}
+
+// Append the row to the page if it has space, widening the page bounds.
+bool append_row(uint8_t* page, const address_database::row& row,
+    uint64_t& height, uint64_t& link)
+{
+    const size_t capacity = page[next_size];
+    const size_t count = page[count_offset];
+    const size_t size = from_little_endian_unsafe<uint16_t>(page +
+        size_offset);
+    const size_t used = from_little_endian_unsafe<uint16_t>(page +
+        used_offset);
+    const auto bytes = row_size(row, height, link);
+
+    if (count == capacity || used + bytes > size)
+        return false;
+
+    BITCOIN_ASSERT(row.height <= max_uint32);
+    const auto row_height = static_cast<uint32_t>(row.height);
+    const auto bounds = page + bounds_offset;
+    const auto min_height = from_little_endian_unsafe<uint32_t>(bounds);
+    const auto max_height = from_little_endian_unsafe<uint32_t>(bounds +
+        height_size);
+
+    auto serial = make_unsafe_serializer(page + count_offset);
+    serial.write_byte(static_cast<uint8_t>(count + 1));
+    serial.skip(bytes_size);
+    serial.write_2_bytes_little_endian(static_cast<uint16_t>(used + bytes));
+    serial.write_4_bytes_little_endian(std::min(min_height, row_height));
+    serial.write_4_bytes_little_endian(std::max(max_height, row_height));
+    serial.skip(used);
+    write_row(serial, row, height, link);
+    return true;
+}
+
+} // namespace database
+} // namespace libbitcoin
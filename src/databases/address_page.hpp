@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_ADDRESS_PAGE_HPP
+#define LIBBITCOIN_DATABASE_ADDRESS_PAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/databases/address_database.hpp>
+
+// Internal to the address database and its iterator, not installed.
+//
+// Page format [22 bytes + up to 42 bytes per row]:
+// ----------------------------------------------------------------------------
+// [ next:8        - const] (next newest page)
+// [ capacity:1    - const] (rows)
+// [ count:1       - atomic1]
+// [ size:2        - const] (bytes of the rows)
+// [ used:2        - atomic1]
+// [ min_height:4  - atomic1] (bounds all rows ever stored in the page)
+// [ max_height:4  - atomic1]
+// [ rows...       - const] (oldest first)
+//
+// Row format [5 to 42 bytes]:
+// ----------------------------------------------------------------------------
+// [ flags:1              ] (output, value implied by data)
+// [ height_delta:varint  ] (zigzag, from the previous row of the page)
+// [ link_delta:varint    ] (zigzag, from the previous row of the page)
+// [ index:varint         ]
+// [ data:varint or 8     ] (output value, or input checksum)
+// [ value:varint         ] (omitted if implied by data)
+
+namespace libbitcoin {
+namespace database {
+
+static constexpr auto next_size = sizeof(file_offset);
+static constexpr auto capacity_size = sizeof(uint8_t);
+static constexpr auto count_size = sizeof(uint8_t);
+static constexpr auto bytes_size = sizeof(uint16_t);
+static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto count_offset = next_size + capacity_size;
+static constexpr auto size_offset = count_offset + count_size;
+static constexpr auto used_offset = size_offset + bytes_size;
+static constexpr auto bounds_offset = used_offset + bytes_size;
+static constexpr auto rows_offset = bounds_offset + 2 * height_size;
+
+/// Write the header of an empty page, with empty height bounds.
+void write_page(uint8_t* page, file_offset next, size_t capacity,
+    size_t size);
+
+/// The link of the next newest page.
+file_offset read_next(const uint8_t* page);
+
+/// The size of the row encoded following a row of the height and link.
+size_t row_size(const address_database::row& row, uint64_t height,
+    uint64_t link);
+
+/// Write the row following a row of the height and link, which are updated.
+void write_row(byte_serializer& serial, const address_database::row& row,
+    uint64_t& height, uint64_t& link);
+
+/// Read the row following a row of the height and link, which are updated.
+address_database::row read_row(byte_deserializer& deserial, uint64_t& height,
+    uint64_t& link);
+
+/// Read the rows of the page, oldest first.
+address_database::row_list read_page(uint8_t* page);
+
+/// Append the row to the page if it has space, widening the page bounds.
+bool append_row(uint8_t* page, const address_database::row& row,
+    uint64_t& height, uint64_t& link);
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
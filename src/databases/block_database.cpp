@@ -18,25 +18,33 @@
  */
 #include <bitcoin/database/databases/block_database.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
+#include <utility>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/checksum.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/header_cache.hpp>
+#include <bitcoin/database/header_columns.hpp>
 #include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/merkle_cache.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
 #include <bitcoin/database/result/block_result.hpp>
+#include <bitcoin/database/short_id.hpp>
 #include <bitcoin/database/state/block_state.hpp>
 
-// Record format (v4) [99 bytes, 135 with key/link]:
+// Record format (v4) [131 bytes, 167 with key/link]:
 // Below excludes block height and tx hash indexes (arrays).
 // ----------------------------------------------------------------------------
 // [ header:80          - const   ]
 // [ median_time_past:4 - const   ]
 // [ height:4           - const   ] (in any branch)
+// [ work:32            - const   ] (cumulative proof of work of the branch)
 // [ state:1            - atomic1 ] (invalid, empty, stored, pooled, indexed, confirmed)
-// [ checksum/code:4    - atomic2 ] (optional, zero if not cached, code if invalid)
+// [ checksum/code:4    - atomic2 ] (crc32c of txs, zero if not populated, code if invalid)
 // [ tx_start:4         - atomic3 ] (array index into the transaction_index, or zero)
 // [ tx_count:2         - atomic3 ] (atomic with start, zero if block unpopulated)
 
@@ -57,29 +65,40 @@ using namespace bc::chain;
 static const auto header_size = header::satoshi_fixed_size();
 static constexpr auto median_time_past_size = sizeof(uint32_t);
 static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto work_size = hash_size;
 static constexpr auto state_size = sizeof(uint8_t);
 static constexpr auto checksum_size = sizeof(uint32_t);
 static constexpr auto tx_start_size = sizeof(uint32_t);
 static constexpr auto tx_count_size = sizeof(uint16_t);
 
 static const auto height_offset = header_size + median_time_past_size;
-static const auto state_offset = height_offset + height_size;
+static const auto work_offset = height_offset + height_size;
+static const auto state_offset = work_offset + work_size;
 static const auto checksum_offset = state_offset + state_size;
 static const auto transactions_offset = checksum_offset + checksum_size;
 
-// Placeholder for unimplemented checksum caching.
+// Header index file header: [ fork_point:4 ][ valid_point:4 ]
+static constexpr auto points_size = 2 * sizeof(uint32_t);
+
+// Heights per pent bitmap record.
+static constexpr size_t byte_bits = 8;
+
+// Headers have no transactions and therefore no checksum.
 static constexpr auto no_checksum = 0u;
 static constexpr auto no_time = 0u;
 
 // Total size of block header and metadta storage.
 static const auto block_size = header_size + median_time_past_size +
-    height_size + state_size + checksum_size + tx_start_size + tx_count_size;
+    height_size + work_size + state_size + checksum_size + tx_start_size + tx_count_size;
 
 // Blocks uses a hash table and two array indexes, all O(1).
 // The block database keys off of block hash and has block value.
 block_database::block_database(const path& map_filename,
     const path& header_index_filename, const path& block_index_filename,
-    const path& tx_index_filename, size_t buckets, size_t expansion)
+    const path& tx_index_filename, const path& short_id_index_filename,
+    const path& tx_hash_index_filename, const path& pent_index_filename,
+    size_t buckets, size_t expansion, bool cache_headers,
+    size_t merkle_capacity)
   : fork_point_(0),
     valid_point_(0),
 
@@ -88,7 +107,7 @@ block_database::block_database(const path& map_filename,
 
     // Array storage.
     header_index_file_(header_index_filename, expansion),
-    header_index_(header_index_file_, 0, sizeof(link_type)),
+    header_index_(header_index_file_, points_size, sizeof(link_type)),
 
     // Array storage.
     block_index_file_(block_index_filename, expansion),
@@ -96,7 +115,24 @@ block_database::block_database(const path& map_filename,
 
     // Array storage.
     tx_index_file_(tx_index_filename, expansion),
-    tx_index_(tx_index_file_, 0, sizeof(file_offset))
+    tx_index_(tx_index_file_, 0, sizeof(file_offset)),
+
+    // Array storage.
+    tx_hash_index_file_(tx_hash_index_filename, expansion),
+    tx_hash_index_(tx_hash_index_file_, 0, hash_size),
+
+    // Array storage.
+    pent_index_file_(pent_index_filename, expansion),
+    pent_index_(pent_index_file_, 0, sizeof(uint8_t)),
+
+    // Array storage.
+    short_id_index_file_(short_id_index_filename, expansion),
+    short_id_index_(short_id_index_file_, 0, mini_hash_size),
+
+    // Memory storage.
+    cache_headers_(cache_headers),
+    header_cache_(block_size),
+    merkle_cache_(merkle_capacity)
 {
 }
 
@@ -113,37 +149,74 @@ bool block_database::create()
     if (!hash_table_file_.open() ||
         !header_index_file_.open() ||
         !block_index_file_.open() ||
-        !tx_index_file_.open())
+        !tx_index_file_.open() ||
+        !tx_hash_index_file_.open() ||
+        !pent_index_file_.open() ||
+        !short_id_index_file_.open())
         return false;
 
     // No need to call open after create.
-    return
+    const auto result =
         hash_table_.create() &&
         header_index_.create() &&
         block_index_.create() &&
-        tx_index_.create();
+        tx_index_.create() &&
+        tx_hash_index_.create() &&
+        pent_index_.create() &&
+        short_id_index_.create();
+
+    if (result)
+        write_points();
+
+    return result;
 }
 
 bool block_database::open()
 {
-    return
+    const auto result =
         hash_table_file_.open() &&
         header_index_file_.open() &&
         block_index_file_.open() &&
         tx_index_file_.open() &&
+        tx_hash_index_file_.open() &&
+        pent_index_file_.open() &&
+        short_id_index_file_.open() &&
 
         hash_table_.start() &&
         header_index_.start() &&
         block_index_.start() &&
-        tx_index_.start();
+        tx_index_.start() &&
+        tx_hash_index_.start() &&
+        pent_index_.start() &&
+        short_id_index_.start() &&
+        read_points();
+
+    if (!result || !cache_headers_)
+        return result;
+
+    // Populate the header cache from the header index.
+    const auto count = header_index_.count();
+    header_cache_.clear();
+    header_cache_.reserve(count);
+    header_columns_.clear();
+    header_columns_.reserve(count);
+
+    for (size_t height = 0; height < count; ++height)
+        cache_push(read_index(height, header_index_), height);
+
+    return true;
 }
 
 void block_database::commit()
 {
+    write_points();
     hash_table_.commit();
     header_index_.commit();
     block_index_.commit();
     tx_index_.commit();
+    tx_hash_index_.commit();
+    pent_index_.commit();
+    short_id_index_.commit();
 }
 
 bool block_database::flush() const
@@ -152,7 +225,10 @@ bool block_database::flush() const
         hash_table_file_.flush() &&
         header_index_file_.flush() &&
         block_index_file_.flush() &&
-        tx_index_file_.flush();
+        tx_index_file_.flush() &&
+        tx_hash_index_file_.flush() &&
+        pent_index_file_.flush() &&
+        short_id_index_file_.flush();
 }
 
 bool block_database::close()
@@ -161,7 +237,22 @@ bool block_database::close()
         hash_table_file_.close() &&
         header_index_file_.close() &&
         block_index_file_.close() &&
-        tx_index_file_.close();
+        tx_index_file_.close() &&
+        tx_hash_index_file_.close() &&
+        pent_index_file_.close() &&
+        short_id_index_file_.close();
+}
+
+bool block_database::attach(write_log& log)
+{
+    return
+        log.attach(hash_table_file_) &&
+        log.attach(header_index_file_) &&
+        log.attach(block_index_file_) &&
+        log.attach(tx_index_file_) &&
+        log.attach(tx_hash_index_file_) &&
+        log.attach(pent_index_file_) &&
+        log.attach(short_id_index_file_);
 }
 
 // Queries.
@@ -185,8 +276,23 @@ bool block_database::top(size_t& out_height, bool block_index) const
 
 block_result block_database::get(size_t height, bool block_index) const
 {
+    array_index link;
+
+    // The cache is read for the record, the element is read only on a miss.
+    if (!block_index && cache_headers_ && header_cache_.link(link, height))
+    {
+        return
+        {
+            hash_table_.find(link),
+            metadata_mutex_,
+            tx_index_,
+            header_cache_,
+            height
+        };
+    }
+
     auto& manager = block_index ? block_index_ : header_index_;
-    const auto link = height < manager.count() ? read_index(height, manager) :
+    link = height < manager.count() ? read_index(height, manager) :
         hash_table_.not_found;
 
     return
@@ -208,26 +314,296 @@ block_result block_database::get(const hash_digest& hash) const
     };
 }
 
+// Index links are read in one pass and record values are then copied in link
+// order under one metadata lock, which also warms the table pages.
+block_result::list block_database::get_range(size_t from, size_t count,
+    bool block_index) const
+{
+    block_result::list results;
+    auto& manager = block_index ? block_index_ : header_index_;
+    const auto top = manager.count();
+
+    if (from >= top || count == 0)
+        return results;
+
+    count = std::min(count, top - from);
+    results.reserve(count);
+
+    // The cache is read for the records, the elements only on a miss.
+    if (!block_index && cache_headers_)
+    {
+        for (auto height = from; height < from + count; ++height)
+            results.push_back(get(height, false));
+
+        return results;
+    }
+
+    std::vector<link_type> links(count);
+
+    // Index records are contiguous, so one memory object covers the range.
+    {
+        const auto memory = manager.get(static_cast<link_type>(from));
+        auto deserial = make_unsafe_deserializer(memory->buffer());
+
+        for (auto& link: links)
+            link = deserial.read_4_bytes_little_endian();
+    }
+
+    std::vector<data_chunk> values(count);
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        shared_lock lock(metadata_mutex_);
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            auto& value = values[index];
+            const auto reader = [&](byte_deserializer& deserial)
+            {
+                value = deserial.read_bytes(block_size);
+            };
+
+            hash_table_.find(links[index]).read(reader);
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (size_t index = 0; index < count; ++index)
+        results.emplace_back(hash_table_.find(links[index]), metadata_mutex_,
+            tx_index_, std::move(values[index]));
+
+    return results;
+}
+
+// Bytes without pent heights are skipped, so sparse ranges scan quickly.
+void block_database::pent_heights(std::vector<size_t>& out_heights,
+    size_t above, size_t limit) const
+{
+    out_heights.clear();
+
+    if (above == max_size_t || limit == 0)
+        return;
+
+    const auto from = above + 1;
+    auto byte = from / byte_bits;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(pent_mutex_);
+
+    const auto count = pent_index_.count();
+
+    if (byte >= count)
+        return;
+
+    // Bitmap records are contiguous, so one memory object covers the range.
+    const auto memory = pent_index_.get(static_cast<array_index>(byte));
+    auto buffer = memory->buffer();
+
+    for (; byte < count && out_heights.size() < limit; ++byte, ++buffer)
+    {
+        if (*buffer == 0)
+            continue;
+
+        for (size_t bit = 0; bit < byte_bits && out_heights.size() < limit;
+            ++bit)
+        {
+            const auto height = byte * byte_bits + bit;
+
+            if (height >= from && ((*buffer >> bit) & 1) != 0)
+                out_heights.push_back(height);
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+const header_columns& block_database::columns() const
+{
+    return header_columns_;
+}
+
+// Reads only the tx association of the block and the one tx index record.
+// This avoids header deserialization and the full tx link set allocation.
+bool block_database::transaction_link(file_offset& out_link, size_t height,
+    size_t position, bool block_index) const
+{
+    auto& manager = block_index ? block_index_ : header_index_;
+
+    if (height >= manager.count())
+        return false;
+
+    const auto element = hash_table_.find(read_index(height, manager));
+
+    array_index tx_start;
+    size_t tx_count;
+
+    // Also false if the block is not yet populated (zero count).
+    if (!read_transactions(tx_start, tx_count, element) ||
+        position >= tx_count)
+        return false;
+
+    const auto index = static_cast<array_index>(tx_start + position);
+    const auto record = tx_index_.get(index);
+    out_link = from_little_endian_unsafe<file_offset>(record->buffer());
+    return true;
+}
+
+// The hashes of a block are contiguous, so this is one sequential read.
+bool block_database::transaction_hashes(hash_list& out_hashes,
+    const hash_digest& hash) const
+{
+    array_index tx_start;
+    size_t tx_count;
+
+    if (!read_transactions(tx_start, tx_count, hash_table_.find(hash)))
+        return false;
+
+    out_hashes.clear();
+    out_hashes.reserve(tx_count);
+    const auto record = tx_hash_index_.get(tx_start);
+    auto deserial = make_unsafe_deserializer(record->buffer());
+
+    for (size_t position = 0; position < tx_count; ++position)
+        out_hashes.push_back(deserial.read_hash());
+
+    return true;
+}
+
+// The tree is built from the stored hash array and cached by block hash.
+bool block_database::merkle_branch(hash_list& out_branch,
+    const hash_digest& hash, size_t position) const
+{
+    auto tree = merkle_cache_.find(hash);
+
+    if (!tree)
+    {
+        hash_list hashes;
+
+        if (!transaction_hashes(hashes, hash))
+            return false;
+
+        tree = merkle_cache::build(std::move(hashes));
+        merkle_cache_.add(hash, tree);
+    }
+
+    if (position >= tree->front().size())
+        return false;
+
+    out_branch = merkle_cache::branch(*tree, position);
+    return true;
+}
+
+// The short ids of a block are contiguous, so this is one sequential read.
+bool block_database::short_ids(uint64_t& out_nonce, short_id_list& out_ids,
+    const hash_digest& hash) const
+{
+    array_index tx_start;
+    size_t tx_count;
+
+    if (!read_transactions(tx_start, tx_count, hash_table_.find(hash)))
+        return false;
+
+    out_ids.clear();
+    out_ids.reserve(tx_count);
+    const auto record = short_id_index_.get(tx_start);
+    auto deserial = make_unsafe_deserializer(record->buffer());
+
+    for (size_t position = 0; position < tx_count; ++position)
+        out_ids.push_back(deserial.read_forward<mini_hash>());
+
+    out_nonce = short_id_nonce(hash);
+    return true;
+}
+
+// Work is const, so it does not require the metadata lock.
+bool block_database::work(uint256_t& out_work, const hash_digest& hash) const
+{
+    const auto element = hash_table_.find(hash);
+
+    if (!element)
+        return false;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(work_offset);
+        out_work = to_uint256(deserial.read_hash());
+    };
+
+    element.read(reader);
+    return true;
+}
+
+// private
+// Zero if the block is not found.
+uint256_t block_database::read_work(const hash_digest& hash) const
+{
+    uint256_t out;
+    return work(out, hash) ? out : 0;
+}
+
+// private
+// Serialize the work as a little-endian 256 bit integer.
+hash_digest block_database::to_hash(uint256_t work)
+{
+    hash_digest out;
+
+    for (auto& byte: out)
+    {
+        byte = static_cast<uint8_t>(work & 0xff);
+        work >>= 8;
+    }
+
+    return out;
+}
+
+// private
+// False if the block is not found or not yet populated (zero count).
+bool block_database::read_transactions(array_index& out_start,
+    size_t& out_count, const const_element& element) const
+{
+    if (!element)
+        return false;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(transactions_offset);
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(metadata_mutex_);
+        out_start = deserial.read_4_bytes_little_endian();
+        out_count = deserial.read_2_bytes_little_endian();
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    element.read(reader);
+    return out_count != 0;
+}
+
 // Store.
 // ----------------------------------------------------------------------------
 
 // private
-void block_database::push(const chain::header& header, size_t height,
-    uint32_t median_time_past, uint32_t checksum, link_type tx_start,
-    size_t tx_count, uint8_t state)
+block_database::link_type block_database::store(const chain::header& header,
+    size_t height, uint32_t median_time_past, uint32_t checksum,
+    link_type tx_start, size_t tx_count, uint8_t state)
 {
-    auto& manager = is_confirmed(state) ? block_index_ : header_index_;
-
     BITCOIN_ASSERT(height <= max_uint32);
     BITCOIN_ASSERT(tx_start <= max_uint32);
     BITCOIN_ASSERT(tx_count <= max_uint16);
     BITCOIN_ASSERT(!header.metadata.pooled);
 
+    // The parent is not found for genesis, so its work is zero.
+    const auto work = read_work(header.previous_block_hash()) +
+        header.proof();
+
     const auto writer = [&](byte_serializer& serial)
     {
         header.to_data(serial, false);
         serial.write_4_bytes_little_endian(median_time_past);
         serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+        serial.write_hash(to_hash(work));
         serial.write_byte(state);
         serial.write_4_bytes_little_endian(checksum);
         serial.write_4_bytes_little_endian(static_cast<uint32_t>(tx_start));
@@ -238,6 +614,17 @@ void block_database::push(const chain::header& header, size_t height,
     auto next = hash_table_.allocator();
     const auto link = next.create(header.hash(), writer);
     hash_table_.link(next);
+    return link;
+}
+
+// private
+void block_database::push(const chain::header& header, size_t height,
+    uint32_t median_time_past, uint32_t checksum, link_type tx_start,
+    size_t tx_count, uint8_t state)
+{
+    auto& manager = is_confirmed(state) ? block_index_ : header_index_;
+    const auto link = store(header, height, median_time_past, checksum,
+        tx_start, tx_count, state);
 
     if (is_confirmed(state) || is_indexed(state))
         push_index(link, height, manager);
@@ -259,6 +646,44 @@ void block_database::push(const chain::header& header, size_t height)
     push(header, height, no_time, no_checksum, 0, 0, state);
 }
 
+// Header index records are allocated once for the full set of headers.
+void block_database::push(const message::header::const_ptr_list& headers,
+    size_t first_height)
+{
+    static const auto state = block_state::indexed | block_state::pent;
+
+    if (headers.empty())
+        return;
+
+    // Records are written before they are counted, so that a reader of the
+    // index never sees an unwritten link.
+    BITCOIN_ASSERT(first_height == header_index_.count());
+    header_index_.reserve(headers.size());
+    auto height = first_height;
+
+    for (const auto& header: headers)
+    {
+        link_type link;
+
+        // The header/block already exists, promote from pooled to indexed.
+        if (header->metadata.pooled)
+        {
+            const auto element = hash_table_.find(header->hash());
+            BITCOIN_ASSERT(element);
+            confirm(element, true, false);
+            link = element.link();
+        }
+        else
+        {
+            link = store(*header, height, no_time, no_checksum, 0, 0, state);
+        }
+
+        write_index(link, height++, header_index_);
+    }
+
+    header_index_.allocate(headers.size());
+}
+
 // This creates a new store entry even if a previous existed.
 // A block creation does not move the fork point (not a reorg).
 void block_database::push(const chain::block& block, size_t height,
@@ -269,23 +694,45 @@ void block_database::push(const chain::block& block, size_t height,
 
     const auto& header = block.header();
     const auto& txs = block.transactions();
-    push(header, height, median_time_past, no_checksum, associate(txs),
+    push(header, height, median_time_past, checksum(txs), associate(block),
         txs.size(), state);
 }
 
-block_database::link_type block_database::associate(
-    const transaction::list& transactions)
+// The hash and short id indexes are allocated in step with the tx index.
+block_database::link_type block_database::associate(const block& block)
 {
+    const auto& transactions = block.transactions();
+
     if (transactions.empty())
         return 0;
 
-    const auto start = tx_index_.allocate(transactions.size());
+    const auto count = transactions.size();
+    const auto start = tx_index_.allocate(count);
     const auto record = tx_index_.get(start);
     auto serial = make_unsafe_serializer(record->buffer());
 
     for (const auto& tx: transactions)
         serial.write_8_bytes_little_endian(tx.metadata.link);
 
+    const auto hashes_start = tx_hash_index_.allocate(count);
+    BITCOIN_ASSERT(hashes_start == start);
+    const auto hashes_record = tx_hash_index_.get(hashes_start);
+    auto hashes_serial = make_unsafe_serializer(hashes_record->buffer());
+
+    for (const auto& tx: transactions)
+        hashes_serial.write_hash(tx.hash());
+
+    const auto ids_start = short_id_index_.allocate(count);
+    BITCOIN_ASSERT(ids_start == start);
+    const auto ids_record = short_id_index_.get(ids_start);
+    auto ids_serial = make_unsafe_serializer(ids_record->buffer());
+
+    const auto& header = block.header();
+    const auto key = to_short_id_key(header, short_id_nonce(header.hash()));
+
+    for (const auto& tx: transactions)
+        ids_serial.write_bytes(short_id(key, tx.hash(true)));
+
     return start;
 }
 
@@ -293,23 +740,25 @@ block_database::link_type block_database::associate(
 // ----------------------------------------------------------------------------
 // These are used to atomically update metadata. 
 
-// Populate transaction references, state is unchanged.
+// Populate transaction references and checksum, state is unchanged.
 bool block_database::update(const chain::block& block)
 {
     const auto& txs = block.transactions();
-    const auto tx_start = associate(txs);
+    const auto tx_start = associate(block);
     const auto tx_count = txs.size();
+    const auto crc = checksum(txs);
 
     BITCOIN_ASSERT(tx_start <= max_uint32);
     BITCOIN_ASSERT(tx_count <= max_uint16);
 
     const auto updater = [&](byte_serializer& serial)
     {
-        serial.skip(transactions_offset);
+        serial.skip(checksum_offset);
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
         unique_lock lock(metadata_mutex_);
+        serial.write_4_bytes_little_endian(crc);
         serial.write_4_bytes_little_endian(static_cast<uint32_t>(tx_start));
         serial.write_2_bytes_little_endian(static_cast<uint16_t>(tx_count));
         ///////////////////////////////////////////////////////////////////////
@@ -321,6 +770,10 @@ bool block_database::update(const chain::block& block)
         return false;
 
     element.write(updater);
+    element.log(checksum_offset, sizeof(uint32_t) + sizeof(uint32_t) +
+        sizeof(uint16_t));
+    cache_update(element);
+    clear_pent(element);
     return true;
 }
 
@@ -354,6 +807,7 @@ bool block_database::validate(const hash_digest& hash, bool positive)
     {
         deserial.skip(height_offset);
         height = deserial.read_4_bytes_little_endian();
+        deserial.skip(work_size);
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
@@ -376,6 +830,9 @@ bool block_database::validate(const hash_digest& hash, bool positive)
 
     element.read(reader);
     element.write(updater);
+    element.log(state_offset, sizeof(uint8_t));
+    cache_update(element);
+    clear_pent(element);
 
     // Also update the validation chaser, assumes all prior are valid.
     BITCOIN_ASSERT_MSG(valid_point_ != max_size_t, "valid point overflow");
@@ -445,6 +902,8 @@ uint8_t block_database::confirm(const_element& element, bool positive,
 
     element.read(reader);
     element.write(updater);
+    element.log(state_offset, sizeof(uint8_t));
+    cache_update(element);
     return positive ? updated : original;
 }
 
@@ -542,6 +1001,17 @@ void block_database::pop_index(size_t height, manager_type& manager)
 
     const auto height32 = static_cast<uint32_t>(height);
     manager.set_count(height32);
+
+    if (&manager != &header_index_)
+        return;
+
+    write_pent(height, false);
+
+    if (cache_headers_)
+    {
+        header_cache_.pop(height);
+        header_columns_.pop(height);
+    }
 }
 
 void block_database::push_index(link_type index, size_t height,
@@ -550,11 +1020,200 @@ void block_database::push_index(link_type index, size_t height,
     BITCOIN_ASSERT(height < max_uint32);
     BITCOIN_ASSERT(height == manager.count());
 
+    // The record is written before it is counted.
+    manager.reserve(1);
+    write_index(index, height, manager);
     manager.allocate(1);
+}
+
+// The record at height must be allocated or reserved.
+void block_database::write_index(link_type index, size_t height,
+    manager_type& manager)
+{
+    BITCOIN_ASSERT(height < max_uint32);
+
     const auto height32 = static_cast<uint32_t>(height);
     const auto record = manager.get(height32);
     auto serial = make_unsafe_serializer(record->buffer());
     serial.write_4_bytes_little_endian(index);
+    manager.log_write(record->buffer(), sizeof(uint32_t));
+
+    if (&manager != &header_index_)
+        return;
+
+    index_pent(index, height);
+
+    if (cache_headers_)
+        cache_push(index, height);
+}
+
+// Chaser Point Utilities.
+// ----------------------------------------------------------------------------
+
+// Restore the chaser points without scanning, rejecting any point that is
+// beyond the top of its index (the store was not committed consistently).
+bool block_database::read_points()
+{
+    // The accessor must remain in scope until the end of the block.
+    const auto memory = header_index_file_.access();
+    auto deserial = make_unsafe_deserializer(memory->buffer());
+    const size_t fork_point = deserial.read_4_bytes_little_endian();
+    const size_t valid_point = deserial.read_4_bytes_little_endian();
+
+    if (fork_point > block_index_.count() ||
+        valid_point > header_index_.count())
+        return false;
+
+    fork_point_ = fork_point;
+    valid_point_ = valid_point;
+    return true;
+}
+
+void block_database::write_points()
+{
+    BITCOIN_ASSERT(fork_point_ < max_uint32);
+    BITCOIN_ASSERT(valid_point_ < max_uint32);
+
+    // The accessor must remain in scope until the end of the block.
+    const auto memory = header_index_file_.access();
+    auto serial = make_unsafe_serializer(memory->buffer());
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(fork_point_));
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(valid_point_));
+    header_index_file_.log_write(memory->buffer(), 2 * sizeof(uint32_t));
+}
+
+// Pent Utilities.
+// ----------------------------------------------------------------------------
+
+// Set the bit of an indexed header if its block is pent and not populated.
+void block_database::index_pent(link_type index, size_t height)
+{
+    const auto element = hash_table_.find(index);
+    BITCOIN_ASSERT(element);
+
+    uint8_t state;
+    size_t tx_count;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(state_offset);
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(metadata_mutex_);
+        state = deserial.read_byte();
+        deserial.skip(checksum_size + tx_start_size);
+        tx_count = deserial.read_2_bytes_little_endian();
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    element.read(reader);
+    write_pent(height, is_pent(state) && tx_count == 0);
+}
+
+// Clear the bit of the element's height if it is the indexed header there.
+void block_database::clear_pent(const const_element& element)
+{
+    uint32_t height;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        deserial.skip(height_offset);
+        height = deserial.read_4_bytes_little_endian();
+    };
+
+    element.read(reader);
+
+    if (height < header_index_.count() &&
+        read_index(height, header_index_) == element.link())
+        write_pent(height, false);
+}
+
+void block_database::write_pent(size_t height, bool pent)
+{
+    BITCOIN_ASSERT(height < max_uint32);
+    const auto byte = height / byte_bits;
+    const auto mask = static_cast<uint8_t>(1u << (height % byte_bits));
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(pent_mutex_);
+
+    const auto count = pent_index_.count();
+
+    if (byte >= count)
+    {
+        // Heights beyond the bitmap are not pent.
+        if (!pent)
+            return;
+
+        // Reallocated records may be dirty, so clear them.
+        const auto added = byte + 1 - count;
+        const auto start = pent_index_.allocate(added);
+        const auto memory = pent_index_.get(start);
+        std::fill_n(memory->buffer(), added, 0x00);
+    }
+
+    const auto memory = pent_index_.get(static_cast<array_index>(byte));
+    const auto buffer = memory->buffer();
+    *buffer = pent ? (*buffer | mask) : (*buffer & ~mask);
+    pent_index_.log_write(buffer, sizeof(uint8_t));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Header Cache Utilities.
+// ----------------------------------------------------------------------------
+
+// Copy the record value, atomic with respect to its metadata.
+data_chunk block_database::read_value(const const_element& element,
+    size_t& out_height) const
+{
+    data_chunk value;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(metadata_mutex_);
+        value = deserial.read_bytes(block_size);
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    element.read(reader);
+    out_height = from_little_endian_unsafe<uint32_t>(value.begin() +
+        height_offset);
+    return value;
+}
+
+void block_database::cache_push(link_type index, size_t height)
+{
+    const auto element = hash_table_.find(index);
+    BITCOIN_ASSERT(element);
+
+    size_t record_height;
+    auto value = read_value(element, record_height);
+    BITCOIN_ASSERT(record_height == height);
+    header_cache_.push(index, element.key(), height, value);
+
+    // The header leads the record value. The record median time past is not
+    // set for pushed headers, so the columns compute it from timestamps.
+    chain::header header;
+    auto deserial = make_unsafe_deserializer(value.data());
+    header.from_data(deserial, false);
+    header_columns_.push(header, height);
+}
+
+// Refresh the cached value if the element is cached (at its height).
+void block_database::cache_update(const const_element& element)
+{
+    if (!cache_headers_)
+        return;
+
+    size_t height;
+    const auto value = read_value(element, height);
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.write_bytes(value);
+    };
+
+    header_cache_.write(element.link(), height, writer);
 }
 
 } // namespace database
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/databases/spender_database.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+
+// Record format [24 bytes]:
+// ----------------------------------------------------------------------------
+// [ key:12            - const] (previous output tx_link:8, index:4)
+// [ next:4            - const]
+// [ tx_link:8         - const] (spending input)
+// [ index:4           - const]
+
+namespace libbitcoin {
+namespace database {
+
+static constexpr auto value_size = sizeof(file_offset) + sizeof(uint32_t);
+
+// Spenders use a hash table index, O(1).
+spender_database::spender_database(const path& lookup_filename,
+    size_t buckets, size_t expansion)
+  : lookup_file_(lookup_filename, expansion),
+    lookup_map_(lookup_file_, buckets, value_size)
+{
+}
+
+spender_database::~spender_database()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool spender_database::create()
+{
+    if (!lookup_file_.open())
+        return false;
+
+    // No need to call open after create.
+    return lookup_map_.create();
+}
+
+bool spender_database::open()
+{
+    return
+        lookup_file_.open() &&
+        lookup_map_.start();
+}
+
+void spender_database::commit()
+{
+    lookup_map_.commit();
+}
+
+bool spender_database::flush() const
+{
+    return lookup_file_.flush();
+}
+
+bool spender_database::close()
+{
+    return lookup_file_.close();
+}
+
+bool spender_database::attach(write_log& log)
+{
+    return log.attach(lookup_file_);
+}
+
+// Queries.
+// ----------------------------------------------------------------------------
+
+bool spender_database::get(point& out_inpoint, const point& outpoint) const
+{
+    const auto element = lookup_map_.find(to_key(outpoint));
+
+    if (!element)
+        return false;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        out_inpoint.first = deserial.read_8_bytes_little_endian();
+        out_inpoint.second = deserial.read_4_bytes_little_endian();
+    };
+
+    element.read(reader);
+    return true;
+}
+
+// Store.
+// ----------------------------------------------------------------------------
+
+void spender_database::store(const point& outpoint, const point& inpoint)
+{
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.write_8_bytes_little_endian(inpoint.first);
+        serial.write_4_bytes_little_endian(inpoint.second);
+    };
+
+    auto next = lookup_map_.allocator();
+    next.create(to_key(outpoint), writer);
+    lookup_map_.link(next);
+}
+
+// Update.
+// ----------------------------------------------------------------------------
+
+// Unlinked records are not reclaimed, as with all record storage.
+bool spender_database::unlink(const point& outpoint)
+{
+    return lookup_map_.unlink(to_key(outpoint));
+}
+
+// private
+spender_database::key_type spender_database::to_key(const point& outpoint)
+{
+    key_type key;
+    auto serial = make_unsafe_serializer(key.data());
+    serial.write_8_bytes_little_endian(outpoint.first);
+    serial.write_4_bytes_little_endian(outpoint.second);
+    return key;
+}
+
+} // namespace database
+} // namespace libbitcoin
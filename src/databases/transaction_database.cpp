@@ -20,6 +20,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <numeric>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/define.hpp>
@@ -39,6 +40,7 @@ using namespace bc::machine;
 // [ position:2          - atomic1 ] (unconfirmed sentinel, could store state)
 // [ state:1             - atomic1 ] (invalid, stored, pooled, indexed, confirmed)
 // [ median_time_past:4  - atomic1 ] (zero if unconfirmed)
+// [ witness:8           - const   ] (witness slab link, or unwitnessed)
 // [ output_count:varint - const   ] (tx starts here)
 // [
 //   [ index_spend:1    - atomic2 ]
@@ -56,6 +58,13 @@ using namespace bc::machine;
 // [ locktime:varint      - const   ]
 // [ version:varint       - const   ]
 
+// Witness format (v4) [unkeyed slab, one witness per input]:
+// ----------------------------------------------------------------------------
+// [
+//   [ element_count:varint - const ]
+//   [ [ element:varint ]... - const ]
+// ]...
+
 // Record format (v3.3):
 // ----------------------------------------------------------------------------
 // [ height/forks:4         - atomic1 ]
@@ -72,6 +81,7 @@ static constexpr auto height_size = sizeof(uint32_t);
 static constexpr auto position_size = sizeof(uint16_t);
 static constexpr auto state_size = sizeof(uint8_t);
 static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto witness_size = sizeof(uint64_t);
 
 static constexpr auto index_spend_size = sizeof(uint8_t);
 ////static constexpr auto height_size = sizeof(uint32_t);
@@ -79,15 +89,23 @@ static constexpr auto value_size = sizeof(uint64_t);
 
 static constexpr auto spend_size = index_spend_size + height_size + value_size;
 static constexpr auto metadata_size = height_size + position_size +
-    state_size + median_time_past_size;
+    state_size + median_time_past_size + witness_size;
 
 static constexpr auto no_time = 0u;
 
 // Transactions uses a hash table index, O(1).
+// Witnesses are split into a separate slab store so that non-witness reads
+// (prevouts, inpoints, txid serving) do not page in witness data.
 transaction_database::transaction_database(const path& map_filename,
-    size_t buckets, size_t expansion, size_t cache_capacity)
+    const path& witness_filename, size_t buckets, size_t expansion,
+    size_t cache_capacity)
   : hash_table_file_(map_filename, expansion),
     hash_table_(hash_table_file_, buckets),
+
+    // Slab storage.
+    witness_file_(witness_filename, expansion),
+    witness_manager_(witness_file_, 0),
+
     cache_(cache_capacity)
 {
 }
@@ -102,34 +120,50 @@ transaction_database::~transaction_database()
 
 bool transaction_database::create()
 {
-    if (!hash_table_file_.open())
+    if (!hash_table_file_.open() ||
+        !witness_file_.open())
         return false;
 
     // No need to call open after create.
     return
-        hash_table_.create();
+        hash_table_.create() &&
+        witness_manager_.create();
 }
 
 bool transaction_database::open()
 {
     return
         hash_table_file_.open() &&
-        hash_table_.start();
+        witness_file_.open() &&
+        hash_table_.start() &&
+        witness_manager_.start();
 }
 
 void transaction_database::commit()
 {
     hash_table_.commit();
+    witness_manager_.commit();
 }
 
 bool transaction_database::flush() const
 {
-    return hash_table_file_.flush();
+    return
+        hash_table_file_.flush() &&
+        witness_file_.flush();
 }
 
 bool transaction_database::close()
 {
-    return hash_table_file_.close();
+    return
+        hash_table_file_.close() &&
+        witness_file_.close();
+}
+
+bool transaction_database::attach(write_log& log)
+{
+    return
+        log.attach(hash_table_file_) &&
+        log.attach(witness_file_);
 }
 
 // Queries.
@@ -138,12 +172,12 @@ bool transaction_database::close()
 transaction_result transaction_database::get(file_offset offset) const
 {
     // This is not guarded for an invalid offset.
-    return { hash_table_.find(offset), metadata_mutex_ };
+    return { hash_table_.find(offset), metadata_mutex_, witness_manager_ };
 }
 
 transaction_result transaction_database::get(const hash_digest& hash) const
 {
-    return { hash_table_.find(hash), metadata_mutex_ };
+    return { hash_table_.find(hash), metadata_mutex_, witness_manager_ };
 }
 
 // Metadata should be defaulted by caller.
@@ -218,17 +252,22 @@ bool transaction_database::store(const chain::transaction& tx, uint32_t height,
     BITCOIN_ASSERT(height <= max_uint32);
     BITCOIN_ASSERT(position <= max_uint16);
 
+    // Witnesses are written first, as the tx record links to them.
+    const auto witness = tx.is_segregated() ? store_witness(tx) :
+        transaction_result::unwitnessed;
+
     const auto writer = [&](byte_serializer& serial)
     {
         serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
         serial.write_2_bytes_little_endian(static_cast<uint16_t>(position));
         serial.write_byte(static_cast<uint8_t>(state));
         serial.write_4_bytes_little_endian(median_time_past);
-        tx.to_data(serial, false, true);
+        serial.write_8_bytes_little_endian(witness);
+        tx.to_data(serial, false, false);
     };
 
     // Transactions are variable-sized.
-    const auto size = metadata_size + tx.serialized_size(false, true);
+    const auto size = metadata_size + tx.serialized_size(false, false);
 
     // Write the new transaction.
     auto next = hash_table_.allocator();
@@ -243,9 +282,38 @@ bool transaction_database::pool(const chain::transaction& tx, uint32_t forks)
         transaction_state::pooled);
 }
 
+// private
+transaction_database::link_type transaction_database::store_witness(
+    const chain::transaction& tx)
+{
+    const auto& inputs = tx.inputs();
+    const auto sizer = [](size_t total, const chain::input& input)
+    {
+        return total + input.witness().serialized_size(true);
+    };
+
+    const auto size = std::accumulate(inputs.begin(), inputs.end(), size_t(0),
+        sizer);
+
+    const auto link = witness_manager_.allocate(size);
+    const auto memory = witness_manager_.get(link);
+    auto serial = make_unsafe_serializer(memory->buffer());
+
+    // One witness per input, empty witnesses are serialized as zero count.
+    for (const auto& input: inputs)
+        input.witness().to_data(serial, true);
+
+    return link;
+}
+
 // Update.
 // ----------------------------------------------------------------------------
 
+bool transaction_database::unspend(file_offset link, uint32_t index)
+{
+    return spend(link, index, output::validation::not_spent);
+}
+
 // private
 bool transaction_database::unspend(const output_point& point)
 {
@@ -264,7 +332,19 @@ bool transaction_database::spend(const output_point& point,
     if (spender_height != output::validation::not_spent)
         cache_.remove(point);
 
-    auto element = hash_table_.find(point.hash());
+    const auto element = hash_table_.find(point.hash());
+
+    if (!element)
+        return false;
+
+    return spend(element.link(), point.index(), spender_height);
+}
+
+// private
+bool transaction_database::spend(link_type link, uint32_t index,
+    size_t spender_height)
+{
+    auto element = hash_table_.find(link);
 
     if (!element)
         return false;
@@ -281,6 +361,7 @@ bool transaction_database::spend(const output_point& point,
         deserial.skip(position_size);
         state = static_cast<transaction_state>(deserial.read_byte());
         deserial.skip(median_time_past_size);
+        deserial.skip(witness_size);
         outputs = deserial.read_size_little_endian();
         ///////////////////////////////////////////////////////////////////////
     };
@@ -292,22 +373,30 @@ bool transaction_database::spend(const output_point& point,
         return false;
 
     // The index is not in the transaction.
-    if (point.index() >= outputs)
+    if (index >= outputs)
         return false;
 
+    // The offset of the spender height, for logging the write.
+    size_t offset = metadata_size;
+
     const auto writer = [&](byte_serializer& serial)
     {
         serial.skip(metadata_size);
-        serial.read_size_little_endian();
+        const auto count = serial.read_size_little_endian();
+        offset += message::variable_uint_size(count);
 
         // Skip outputs until the target output.
-        for (uint32_t output = 0; output < point.index(); ++output)
+        for (uint32_t output = 0; output < index; ++output)
         {
             serial.skip(spend_size);
-            serial.skip(serial.read_size_little_endian());
+            const auto script_size = serial.read_size_little_endian();
+            serial.skip(script_size);
+            offset += spend_size + message::variable_uint_size(script_size) +
+                script_size;
         }
 
         serial.skip(index_spend_size);
+        offset += index_spend_size;
 
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
@@ -317,6 +406,7 @@ bool transaction_database::spend(const output_point& point,
     };
 
     element.write(writer);
+    element.log(offset, sizeof(uint32_t));
     return true;
 }
 
@@ -331,6 +421,11 @@ bool transaction_database::unconfirm(file_offset link)
         if (!unspend(inpoint))
             return false;
 
+    return demote(link);
+}
+
+bool transaction_database::demote(file_offset link)
+{
     // The tx was verified under a now unknown chain state, so set unverified.
     return update(link, rule_fork::unverified, no_time,
         transaction_result::unconfirmed, transaction_state::pooled);
@@ -392,6 +487,7 @@ bool transaction_database::update(link_type link, size_t height,
     };
 
     element.write(writer);
+    element.log(0, metadata_size);
     return true;
 }
 
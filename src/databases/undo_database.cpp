@@ -0,0 +1,250 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/databases/undo_database.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+
+// Index record format [8 bytes]:
+// ----------------------------------------------------------------------------
+// [ journal:8 - const] (not_allocated if no journal)
+//
+// Journal slab format:
+// ----------------------------------------------------------------------------
+// [ spend_count:varint - const]
+// [ [ tx_link:8 ][ index:4 ]...] (spent previous outputs)
+// [ with_rows:1      - const] (zero if address rows were not journaled)
+// [ row_count:varint - const]
+// [ [ address_hash:20 ]...] (address rows in store order)
+
+namespace libbitcoin {
+namespace database {
+
+static constexpr auto spend_size = sizeof(file_offset) + sizeof(uint32_t);
+
+undo_database::undo_database(const path& index_filename,
+    const path& journal_filename, size_t expansion)
+  : index_file_(index_filename, expansion),
+    index_(index_file_, 0, sizeof(link_type)),
+    journal_file_(journal_filename, expansion),
+    journal_(journal_file_, 0)
+{
+}
+
+undo_database::~undo_database()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool undo_database::create()
+{
+    if (!index_file_.open() ||
+        !journal_file_.open())
+        return false;
+
+    // No need to call open after create.
+    return
+        index_.create() &&
+        journal_.create();
+}
+
+bool undo_database::open()
+{
+    return
+        index_file_.open() &&
+        journal_file_.open() &&
+        index_.start() &&
+        journal_.start();
+}
+
+void undo_database::commit()
+{
+    index_.commit();
+    journal_.commit();
+}
+
+bool undo_database::flush() const
+{
+    return
+        index_file_.flush() &&
+        journal_file_.flush();
+}
+
+bool undo_database::close()
+{
+    return
+        index_file_.close() &&
+        journal_file_.close();
+}
+
+bool undo_database::attach(write_log& log)
+{
+    return
+        log.attach(index_file_) &&
+        log.attach(journal_file_);
+}
+
+// Queries.
+// ----------------------------------------------------------------------------
+
+bool undo_database::get(spend_list& out_spends, short_hash_list& out_rows,
+    size_t height) const
+{
+    out_spends.clear();
+    out_rows.clear();
+    const auto link = read_link(height);
+
+    if (link == journal_manager::not_allocated)
+        return false;
+
+    const auto memory = journal_.get(link);
+    auto deserial = make_unsafe_deserializer(memory->buffer());
+
+    out_spends.resize(deserial.read_size_little_endian());
+
+    for (auto& spend: out_spends)
+    {
+        spend.first = deserial.read_8_bytes_little_endian();
+        spend.second = deserial.read_4_bytes_little_endian();
+    }
+
+    deserial.skip(sizeof(uint8_t));
+    out_rows.resize(deserial.read_size_little_endian());
+
+    for (auto& row: out_rows)
+        row = deserial.read_short_hash();
+
+    return true;
+}
+
+bool undo_database::has_rows(size_t height) const
+{
+    const auto link = read_link(height);
+
+    if (link == journal_manager::not_allocated)
+        return false;
+
+    const auto memory = journal_.get(link);
+    auto deserial = make_unsafe_deserializer(memory->buffer());
+    deserial.skip(deserial.read_size_little_endian() * spend_size);
+    return deserial.read_byte() != 0;
+}
+
+// private
+undo_database::link_type undo_database::read_link(size_t height) const
+{
+    if (height >= index_.count())
+        return journal_manager::not_allocated;
+
+    const auto record = index_.get(static_cast<index_type>(height));
+    return from_little_endian_unsafe<link_type>(record->buffer());
+}
+
+// Store.
+// ----------------------------------------------------------------------------
+
+bool undo_database::store(const spend_list& spends,
+    const short_hash_list& rows, size_t height)
+{
+    return store(spends, rows, true, height);
+}
+
+bool undo_database::store(const spend_list& spends, size_t height)
+{
+    return store(spends, {}, false, height);
+}
+
+// private
+bool undo_database::store(const spend_list& spends,
+    const short_hash_list& rows, bool with_rows, size_t height)
+{
+    const auto count = index_.count();
+
+    // Journals are stored in block index order.
+    if (height < count || height >= max_uint32)
+        return false;
+
+    const auto size =
+        message::variable_uint_size(spends.size()) +
+        spends.size() * spend_size +
+        sizeof(uint8_t) +
+        message::variable_uint_size(rows.size()) +
+        rows.size() * short_hash_size;
+
+    const auto link = journal_.allocate(size);
+    const auto memory = journal_.get(link);
+    auto serial = make_unsafe_serializer(memory->buffer());
+
+    serial.write_size_little_endian(spends.size());
+
+    for (const auto& spend: spends)
+    {
+        serial.write_8_bytes_little_endian(spend.first);
+        serial.write_4_bytes_little_endian(spend.second);
+    }
+
+    serial.write_byte(with_rows ? 1 : 0);
+    serial.write_size_little_endian(rows.size());
+
+    for (const auto& row: rows)
+        serial.write_short_hash(row);
+
+    // Heights without a journal (not confirmed by push) are skipped.
+    const auto start = index_.allocate(height + 1 - count);
+
+    for (auto skipped = start; skipped < height; ++skipped)
+    {
+        const auto record = index_.get(skipped);
+        auto empty = make_unsafe_serializer(record->buffer());
+        empty.write_8_bytes_little_endian(journal_manager::not_allocated);
+    }
+
+    const auto record = index_.get(static_cast<index_type>(height));
+    auto journal = make_unsafe_serializer(record->buffer());
+    journal.write_8_bytes_little_endian(link);
+    return true;
+}
+
+// Update.
+// ----------------------------------------------------------------------------
+
+// The popped journal slab is not reclaimed, as with all slab storage.
+// The top may be a skipped height, and a height above the index (confirmed
+// before any journal was stored) has nothing to remove.
+bool undo_database::pop(size_t height)
+{
+    const auto count = index_.count();
+
+    if (height >= count)
+        return true;
+
+    if (height + 1 != count)
+        return false;
+
+    index_.set_count(static_cast<index_type>(height));
+    return true;
+}
+
+} // namespace database
+} // namespace libbitcoin
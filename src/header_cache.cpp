@@ -0,0 +1,180 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/header_cache.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+// Cached record format:
+// ----------------------------------------------------------------------------
+// [ link:4  ] (hash table link of the record)
+// [ key:32  ] (block hash)
+// [ value:* ] (copy of the hash table record value)
+
+static constexpr auto link_size = sizeof(array_index);
+static constexpr auto key_size = hash_size;
+
+header_cache::header_cache(size_t value_size)
+  : value_size_(value_size),
+    record_size_(link_size + key_size + value_size)
+{
+}
+
+bool header_cache::empty() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return records_.empty();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t header_cache::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return records_.size() / record_size_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_cache::reserve(size_t count)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    records_.reserve(count * record_size_);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_cache::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    records_.clear();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_cache::push(array_index link, const hash_digest& key,
+    size_t height, const data_chunk& value)
+{
+    BITCOIN_ASSERT(value.size() == value_size_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    BITCOIN_ASSERT(height == records_.size() / record_size_);
+    records_.resize(records_.size() + record_size_);
+
+    auto serial = make_unsafe_serializer(record(height));
+    serial.write_4_bytes_little_endian(link);
+    serial.write_hash(key);
+    serial.write_bytes(value);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_cache::pop(size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    BITCOIN_ASSERT(height + 1u == records_.size() / record_size_);
+    records_.resize(height * record_size_);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool header_cache::link(array_index& out_link, size_t height) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (height >= records_.size() / record_size_)
+        return false;
+
+    out_link = from_little_endian_unsafe<array_index>(record(height));
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// False if the height is not cached or has been reorganized to another link.
+bool header_cache::read(hash_digest& out_key, array_index link, size_t height,
+    read_function reader) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (height >= records_.size() / record_size_)
+        return false;
+
+    auto deserial = make_unsafe_deserializer(record(height));
+
+    if (deserial.read_4_bytes_little_endian() != link)
+        return false;
+
+    out_key = deserial.read_hash();
+    reader(deserial);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// False if the height is not cached or has been reorganized to another link.
+bool header_cache::write(array_index link, size_t height,
+    write_function writer)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (height >= records_.size() / record_size_)
+        return false;
+
+    const auto memory = record(height);
+
+    if (from_little_endian_unsafe<array_index>(memory) != link)
+        return false;
+
+    auto serial = make_unsafe_serializer(memory + link_size + key_size);
+    writer(serial);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Deserializers require a mutable pointer, protection is provided by mutex.
+uint8_t* header_cache::record(size_t height) const
+{
+    return const_cast<uint8_t*>(records_.data()) + height * record_size_;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/header_columns.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+// The number of preceding timestamps in a median time past.
+static constexpr size_t median_time_past_count = 11;
+
+size_t header_columns::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return versions_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_columns::reserve(size_t count)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    versions_.reserve(count);
+    timestamps_.reserve(count);
+    bits_.reserve(count);
+    median_time_pasts_.reserve(count);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_columns::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    versions_.clear();
+    timestamps_.clear();
+    bits_.clear();
+    median_time_pasts_.clear();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_columns::push(const chain::header& header, size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    BITCOIN_ASSERT(height == versions_.size());
+    versions_.push_back(header.version());
+    timestamps_.push_back(header.timestamp());
+    bits_.push_back(header.bits());
+    median_time_pasts_.push_back(median_time_past());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_columns::pop(size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    BITCOIN_ASSERT(height + 1u == versions_.size());
+    versions_.resize(height);
+    timestamps_.resize(height);
+    bits_.resize(height);
+    median_time_pasts_.resize(height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool header_columns::versions(column& out, size_t from, size_t count) const
+{
+    return read(out, versions_, from, count);
+}
+
+bool header_columns::timestamps(column& out, size_t from, size_t count) const
+{
+    return read(out, timestamps_, from, count);
+}
+
+bool header_columns::bits(column& out, size_t from, size_t count) const
+{
+    return read(out, bits_, from, count);
+}
+
+bool header_columns::median_time_pasts(column& out, size_t from,
+    size_t count) const
+{
+    return read(out, median_time_pasts_, from, count);
+}
+
+// private
+// The median of the (up to) 11 timestamps preceding the top height, as in
+// chain_state. This is called with the top timestamp already pushed.
+uint32_t header_columns::median_time_past() const
+{
+    BITCOIN_ASSERT(!timestamps_.empty());
+    const auto end = timestamps_.end() - 1;
+    const auto count = std::min(median_time_past_count,
+        timestamps_.size() - 1u);
+
+    column times(end - count, end);
+
+    if (times.empty())
+        return 0;
+
+    const auto middle = times.begin() + times.size() / 2;
+    std::nth_element(times.begin(), middle, times.end());
+    return *middle;
+}
+
+// private
+bool header_columns::read(column& out, const column& source, size_t from,
+    size_t count) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (from > source.size() || count > source.size() - from)
+        return false;
+
+    const auto begin = source.begin() + from;
+    out.assign(begin, begin + count);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -28,6 +28,7 @@
     #include <stddef.h>
     #include <sys/mman.h>
 #endif
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <fcntl.h>
@@ -40,6 +41,7 @@
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database/memory/accessor.hpp>
 #include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 
 // file_storage is able to support 32 bit, but because the database
 // requires a larger file this is neither validated nor supported.
@@ -154,7 +156,12 @@ file_storage::file_storage(const path& filename, size_t expansion)
     closed_(true),
     data_(nullptr),
     file_size_(file_size(file_handle_)),
-    logical_size_(file_size_)
+    logical_size_(file_size_),
+    log_(nullptr),
+    log_index_(0),
+    allocated_(max_size_t),
+    reallocated_(max_size_t),
+    allocated_size_(logical_size_)
 {
 }
 
@@ -223,6 +230,11 @@ bool file_storage::flush() const
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+    // All allocations are flushed.
+    allocated_ = max_size_t;
+    reallocated_ = max_size_t;
+    allocated_size_ = logical_size_;
+
     if (msync(data_, logical_size_, MS_SYNC) == FAIL)
         error_name = "flush";
 
@@ -385,6 +397,96 @@ memory_ptr file_storage::reserve(size_t size, size_t expansion)
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// Write logging.
+// ----------------------------------------------------------------------------
+
+void file_storage::attach(write_log& log, size_t index)
+{
+    log_ = &log;
+    log_index_ = index;
+}
+
+// The caller holds access, so the map cannot move.
+void file_storage::log_write(const uint8_t* data, size_t size)
+{
+    if (log_ == nullptr)
+        return;
+
+    BITCOIN_ASSERT(data >= data_ && data + size <= data_ + logical_size_);
+    log_->write(log_index_, data - data_, data, size);
+}
+
+static void set_lowest(std::atomic<size_t>& lowest, size_t offset)
+{
+    auto value = lowest.load();
+    while (offset < value && !lowest.compare_exchange_weak(value, offset));
+}
+
+// The manager allocation is serialized and follows reserve, so the logical
+// size is the end of the allocation.
+void file_storage::log_allocation(size_t offset)
+{
+    if (log_ == nullptr)
+        return;
+
+    set_lowest(allocated_, offset);
+
+    // Space truncated by the manager (pop) may be the target of logged writes.
+    if (offset < allocated_size_)
+        set_lowest(reallocated_, offset);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    allocated_size_ = std::max(allocated_size_.load(), logical_size_);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Allocations are appended, so this is the tail of the logical map.
+// Reallocated space is logged after the writes to it, so replay of earlier
+// writes to the same space is superseded.
+bool file_storage::flush_allocations()
+{
+    const auto offset = allocated_.exchange(max_size_t);
+    const auto reallocated = reallocated_.exchange(max_size_t);
+
+    if (offset == max_size_t)
+        return true;
+
+    std::string error_name;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    if (!closed_ && reallocated < logical_size_ && log_ != nullptr)
+        log_->write(log_index_, reallocated, data_ + reallocated,
+            logical_size_ - reallocated);
+
+    if (!closed_ && offset < logical_size_)
+    {
+        // msync requires a page aligned address.
+        const auto start = offset - (offset % page());
+
+        if (msync(data_ + start, logical_size_ - start, MS_SYNC) == FAIL)
+            error_name = "flush";
+    }
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    if (!error_name.empty())
+        return handle_error(error_name, filename_);
+
+    return true;
+}
+
+const file_storage::path& file_storage::filename() const
+{
+    return filename_;
+}
+
 // privates
 // ----------------------------------------------------------------------------
 
@@ -0,0 +1,375 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/write_log.hpp>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include "../mman-win32/mman.h"
+#else
+    #include <unistd.h>
+#endif
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <iterator>
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+
+// Batch format:
+// ----------------------------------------------------------------------------
+// [ size:4     ] (bytes of the records)
+// [ checksum:4 ] (bitcoin checksum of the records)
+// [ [ file:1 ][ offset:8 ][ size:2 ][ data ]... ]
+
+namespace libbitcoin {
+namespace database {
+
+#define FAIL -1
+#define INVALID_HANDLE -1
+
+static constexpr auto batch_header_size = 2 * sizeof(uint32_t);
+static constexpr auto record_header_size = sizeof(uint8_t) +
+    sizeof(file_offset) + sizeof(uint16_t);
+
+// A checkpoint flushes all files, so the log is small relative to the files.
+const size_t write_log::checkpoint_size = 64 * 1024 * 1024;
+
+static int open_log(const boost::filesystem::path& filename)
+{
+#ifdef _WIN32
+    return _wopen(filename.wstring().c_str(),
+        (O_RDWR | O_CREAT | O_APPEND | _O_BINARY), (_S_IREAD | _S_IWRITE));
+#else
+    return ::open(filename.string().c_str(), (O_RDWR | O_CREAT | O_APPEND),
+        (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+#endif
+}
+
+static bool write_all(int file_handle, const data_chunk& data)
+{
+    size_t written = 0;
+
+    while (written < data.size())
+    {
+        const auto result = ::write(file_handle, data.data() + written,
+            data.size() - written);
+
+        if (result == FAIL)
+            return false;
+
+        written += static_cast<size_t>(result);
+    }
+
+    return true;
+}
+
+write_log::write_log(const path& filename, const paths& files)
+  : filename_(filename),
+    files_(files),
+    file_handle_(INVALID_HANDLE),
+    size_(0),
+    sequences_(0)
+{
+    BITCOIN_ASSERT(files.size() <= max_uint8);
+}
+
+write_log::~write_log()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool write_log::open()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(sequence_mutex_);
+
+    if (file_handle_ != INVALID_HANDLE)
+        return false;
+
+    file_handle_ = open_log(filename_);
+
+    if (file_handle_ == INVALID_HANDLE)
+        return false;
+
+    const auto end = ::lseek(file_handle_, 0, SEEK_END);
+    size_ = end == FAIL ? 0 : static_cast<size_t>(end);
+    return end != FAIL;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool write_log::close()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(sequence_mutex_);
+
+    attached_.clear();
+
+    if (file_handle_ == INVALID_HANDLE)
+        return true;
+
+    const auto closed = ::close(file_handle_) != FAIL;
+    file_handle_ = INVALID_HANDLE;
+    return closed;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool write_log::attach(file_storage& file)
+{
+    const auto it = std::find(files_.begin(), files_.end(), file.filename());
+
+    if (it == files_.end())
+        return false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(sequence_mutex_);
+    file.attach(*this, static_cast<size_t>(std::distance(files_.begin(),
+        it)));
+    attached_.push_back(&file);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Logging.
+// ----------------------------------------------------------------------------
+
+// Larger writes are split, in-place writes are small so this is rare.
+void write_log::write(size_t file, file_offset offset, const uint8_t* data,
+    size_t size)
+{
+    BITCOIN_ASSERT(file < files_.size());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(buffer_mutex_);
+
+    while (size != 0)
+    {
+        const auto chunk = std::min(size, size_t(max_uint16));
+        const auto start = buffer_.size();
+        buffer_.resize(start + record_header_size + chunk);
+
+        auto serial = make_unsafe_serializer(buffer_.data() + start);
+        serial.write_byte(static_cast<uint8_t>(file));
+        serial.write_8_bytes_little_endian(offset);
+        serial.write_2_bytes_little_endian(static_cast<uint16_t>(chunk));
+        serial.write_bytes(data, chunk);
+
+        data += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The start handler is invoked only on the first of overlapping sequences.
+bool write_log::begin(sequence_handler start)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(sequence_mutex_);
+
+    if (sequences_ == 0 && !start())
+        return false;
+
+    ++sequences_;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// A sequence beginning while the log commits waits, so that neither a batch
+// nor a checkpoint includes the writes of an incomplete sequence. The stop
+// handler is invoked only on the last of overlapping sequences, and not if
+// the commit fails.
+bool write_log::end(flush_handler flush, sequence_handler stop)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(sequence_mutex_);
+    BITCOIN_ASSERT(sequences_ != 0);
+
+    if (--sequences_ != 0)
+        return true;
+
+    if (!commit())
+        return false;
+
+    // The files are flushed, so the batches are no longer required.
+    if (size_ > checkpoint_size && !(flush() && reset()))
+        return false;
+
+    return stop();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Allocated space must be durable before the batch that refers to it.
+bool write_log::commit()
+{
+    for (const auto file: attached_)
+        if (!file->flush_allocations())
+            return false;
+
+    data_chunk batch;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    buffer_mutex_.lock();
+
+    if (buffer_.empty())
+    {
+        buffer_mutex_.unlock();
+        //---------------------------------------------------------------------
+        return true;
+    }
+
+    batch.resize(batch_header_size);
+    auto serial = make_unsafe_serializer(batch.data());
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(buffer_.size()));
+    serial.write_4_bytes_little_endian(bitcoin_checksum(buffer_));
+    extend_data(batch, buffer_);
+    buffer_.clear();
+
+    buffer_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (file_handle_ == INVALID_HANDLE || !write_all(file_handle_, batch) ||
+        fsync(file_handle_) == FAIL)
+        return false;
+
+    size_ += batch.size();
+    return true;
+}
+
+// Recovery.
+// ----------------------------------------------------------------------------
+
+bool write_log::replay(replay_handler handler) const
+{
+    data_chunk log;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        shared_lock lock(sequence_mutex_);
+
+        if (file_handle_ == INVALID_HANDLE)
+            return false;
+
+        log.resize(size_);
+
+        if (::lseek(file_handle_, 0, SEEK_SET) == FAIL)
+            return false;
+
+        size_t read = 0;
+
+        while (read < log.size())
+        {
+            const auto result = ::read(file_handle_, log.data() + read,
+                log.size() - read);
+
+            if (result == FAIL || result == 0)
+                return false;
+
+            read += static_cast<size_t>(result);
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    auto deserial = make_unsafe_deserializer(log.data());
+    size_t position = 0;
+
+    while (log.size() - position >= batch_header_size)
+    {
+        const size_t size = deserial.read_4_bytes_little_endian();
+        const auto checksum = deserial.read_4_bytes_little_endian();
+        position += batch_header_size;
+
+        // The last batch may have been torn by the crash.
+        if (log.size() - position < size)
+            break;
+
+        const auto first = log.begin() + position;
+        const data_chunk records(first, first + size);
+
+        if (bitcoin_checksum(records) != checksum)
+            break;
+
+        for (auto record = records.begin(); record != records.end();)
+        {
+            auto reader = make_unsafe_deserializer(&*record);
+            const size_t file = reader.read_byte();
+            const auto offset = reader.read_8_bytes_little_endian();
+            const size_t bytes = reader.read_2_bytes_little_endian();
+            record += record_header_size;
+
+            if (file >= files_.size() || records.end() - record <
+                static_cast<ptrdiff_t>(bytes))
+                return false;
+
+            if (!handler(file, offset, { record, record + bytes }))
+                return false;
+
+            record += bytes;
+        }
+
+        deserial.skip(size);
+        position += size;
+    }
+
+    return true;
+}
+
+bool write_log::reset()
+{
+    if (file_handle_ == INVALID_HANDLE || ftruncate(file_handle_, 0) == FAIL ||
+        fsync(file_handle_) == FAIL)
+        return false;
+
+    size_ = 0;
+    return true;
+}
+
+size_t write_log::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(sequence_mutex_);
+    return size_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+const write_log::paths& write_log::files() const
+{
+    return files_;
+}
+
+} // namespace database
+} // namespace libbitcoin
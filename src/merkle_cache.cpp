@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/merkle_cache.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+// Bitcoin pairs the last hash of an odd level with itself.
+static hash_digest pair_hash(const hash_digest& left, const hash_digest& right)
+{
+    std::array<uint8_t, 2 * hash_size> pair;
+    std::copy(left.begin(), left.end(), pair.begin());
+    std::copy(right.begin(), right.end(), pair.begin() + hash_size);
+    return bitcoin_hash(pair);
+}
+
+merkle_cache::tree_ptr merkle_cache::build(hash_list&& hashes)
+{
+    BITCOIN_ASSERT(!hashes.empty());
+    const auto out = std::make_shared<tree>();
+    out->push_back(std::move(hashes));
+
+    while (out->back().size() > 1)
+    {
+        const auto& level = out->back();
+        const auto size = level.size();
+        hash_list next;
+        next.reserve((size + 1) / 2);
+
+        for (size_t index = 0; index < size; index += 2)
+        {
+            const auto& left = level[index];
+            const auto& right = index + 1 < size ? level[index + 1] : left;
+            next.push_back(pair_hash(left, right));
+        }
+
+        out->push_back(std::move(next));
+    }
+
+    return out;
+}
+
+hash_list merkle_cache::branch(const tree& tree, size_t position)
+{
+    hash_list out;
+
+    if (tree.empty() || position >= tree.front().size())
+        return out;
+
+    out.reserve(tree.size() - 1);
+
+    // The root level has no sibling.
+    for (size_t depth = 0; depth + 1 < tree.size(); ++depth)
+    {
+        const auto& level = tree[depth];
+        const auto sibling = position ^ 1;
+        out.push_back(sibling < level.size() ? level[sibling] :
+            level[position]);
+        position >>= 1;
+    }
+
+    return out;
+}
+
+merkle_cache::merkle_cache(size_t capacity)
+  : capacity_(capacity), sequence_(0)
+{
+}
+
+bool merkle_cache::disabled() const
+{
+    return capacity_ == 0;
+}
+
+size_t merkle_cache::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return trees_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void merkle_cache::add(const hash_digest& block_hash, tree_ptr tree)
+{
+    if (disabled())
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // It's been a long time since the last restart.
+    if (sequence_ == max_uint32)
+        trees_.clear();
+
+    // A concurrent query may have added the same tree.
+    if (trees_.left.find(block_hash) != trees_.left.end())
+        return;
+
+    // Remove the least recently used entry if the cache is at capacity.
+    if (trees_.size() >= capacity_)
+        trees_.right.erase(trees_.right.begin());
+
+    trees_.insert(trees::value_type(block_hash, ++sequence_, tree));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+merkle_cache::tree_ptr merkle_cache::find(const hash_digest& block_hash)
+{
+    if (disabled())
+        return nullptr;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto it = trees_.left.find(block_hash);
+
+    if (it == trees_.left.end() || sequence_ == max_uint32)
+        return nullptr;
+
+    // Mark the entry as most recently used.
+    trees_.left.replace_data(it, ++sequence_);
+    return it->info;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -18,62 +18,94 @@
  */
 #include <bitcoin/database/result/address_iterator.hpp>
 
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+#include "../databases/address_page.hpp"
+
 namespace libbitcoin {
 namespace database {
 
 using namespace bc::chain;
 
-address_iterator::address_iterator(const const_element& element)
-  : element_(element)
+address_iterator::address_iterator(const manager& manager,
+    shared_mutex& mutex, link_type page)
+  : manager_(manager),
+    mutex_(mutex),
+    page_(page),
+    next_(manager::not_allocated),
+    index_(0)
 {
     populate();
 }
 
+// Because it is common to not return all addresses, based on a total count
+// and/or height limitation, the set is read one contiguous page at a time.
 void address_iterator::populate()
 {
-    // Because it is common to not return all addresses, based on a total count
-    // and/or height limitation, and because the set is contained in a
-    // discontiguous list, we do not prepopulate the full set here. However,
-    // this behavior can be modified within this iterator as desired.
-    if (!element_.terminal())
+    payments_.clear();
+    index_ = 0;
+
+    // Pages are not empty, but a page may be emptied after it is found.
+    while (page_ != manager::not_allocated && payments_.empty())
     {
-        element_.read([&](byte_deserializer& deserial)
-        {
-            payment_.from_data(deserial, false);
-        });
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(mutex_);
+
+        const auto memory = manager_.get(page_);
+        const auto buffer = memory->buffer();
+        next_ = read_next(buffer);
+
+        // Rows are stored oldest first.
+        const auto rows = read_page(buffer);
+        payments_.reserve(rows.size());
+
+        for (auto row = rows.rbegin(); row != rows.rend(); ++row)
+            payments_.push_back(row->payment);
+        ///////////////////////////////////////////////////////////////////////
+
+        if (payments_.empty())
+            page_ = next_;
     }
 }
 
+void address_iterator::increment()
+{
+    if (++index_ < payments_.size())
+        return;
+
+    page_ = next_;
+    populate();
+}
+
 address_iterator::pointer address_iterator::operator->() const
 {
-    return payment_;
+    return payments_[index_];
 }
 
 address_iterator::reference address_iterator::operator*() const
 {
-    return payment_;
+    return payments_[index_];
 }
 
 address_iterator::iterator& address_iterator::operator++()
 {
-    element_.jump_next();
-    populate();
+    increment();
     return *this;
 }
 
 address_iterator::iterator address_iterator::operator++(int)
 {
     auto it = *this;
-    element_.jump_next();
-    populate();
+    increment();
     return it;
 }
 
 bool address_iterator::operator==(const address_iterator& other) const
 {
-    // This is sufficient due to the behavior of the list_element equality
-    // operator override. Only the link values are compared.
-    return element_ == other.element_;
+    // Only the page and row positions are compared.
+    return page_ == other.page_ && index_ == other.index_;
 }
 
 bool address_iterator::operator!=(const address_iterator& other) const
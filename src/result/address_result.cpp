@@ -18,24 +18,21 @@
  */
 #include <bitcoin/database/result/address_result.hpp>
 
-#include <cstdint>
 #include <bitcoin/bitcoin.hpp>
-#include <bitcoin/database/databases/transaction_database.hpp>
-#include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/result/address_iterator.hpp>
 
 namespace libbitcoin {
 namespace database {
 
-address_result::address_result(const const_value_type& element,
-    const short_hash& hash)
-  : hash_(hash), element_(element)
+address_result::address_result(const manager& manager, shared_mutex& mutex,
+    link_type page, const short_hash& hash)
+  : hash_(hash), page_(page), manager_(manager), mutex_(mutex)
 {
 }
 
 address_result::operator bool() const
 {
-    return element_;
+    return page_ != manager::not_allocated;
 }
 
 const short_hash& address_result::hash() const
@@ -45,12 +42,12 @@ const short_hash& address_result::hash() const
 
 address_iterator address_result::begin() const
 {
-    return { element_ };
+    return { manager_, mutex_, page_ };
 }
 
 address_iterator address_result::end() const
 {
-    return { element_.terminator() };
+    return { manager_, mutex_, manager::not_allocated };
 }
 
 } // namespace database
@@ -22,6 +22,7 @@
 #include <cstddef>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/checksum.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/result/transaction_iterator.hpp>
@@ -35,23 +36,26 @@ using namespace bc::chain;
 static const auto header_size = header::satoshi_fixed_size();
 static constexpr auto median_time_past_size = sizeof(uint32_t);
 static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto work_size = hash_size;
 static constexpr auto state_size = sizeof(uint8_t);
 static constexpr auto checksum_size = sizeof(uint32_t);
 static constexpr auto tx_start_size = sizeof(uint32_t);
 static constexpr auto tx_count_size = sizeof(uint16_t);
 
 static const auto height_offset = header_size + median_time_past_size;
-static const auto state_offset = height_offset + height_size;
+static const auto work_offset = height_offset + height_size;
+static const auto state_offset = work_offset + work_size;
 static const auto checksum_offset = state_offset + state_size;
 static const auto transactions_offset = checksum_offset + checksum_size;
 
-// Placeholder for unimplemented checksum caching.
+// Headers have no transactions and therefore no checksum.
 static constexpr auto no_checksum = 0u;
 
 block_result::block_result(const const_element_type& element,
     shared_mutex& metadata_mutex, const manager& index_manager)
   : height_(0),
     median_time_past_(0),
+    work_(0),
     state_(block_state::missing),
     checksum_(no_checksum),
     tx_start_(0),
@@ -63,6 +67,63 @@ block_result::block_result(const const_element_type& element,
     if (!element_)
         return;
 
+    populate();
+}
+
+block_result::block_result(const const_element_type& element,
+    shared_mutex& metadata_mutex, const manager& index_manager,
+    const header_cache& cache, size_t height)
+  : height_(0),
+    median_time_past_(0),
+    work_(0),
+    state_(block_state::missing),
+    checksum_(no_checksum),
+    tx_start_(0),
+    tx_count_(0),
+    element_(element),
+    index_manager_(index_manager),
+    metadata_mutex_(metadata_mutex)
+{
+    if (!element_)
+        return;
+
+    hash_digest hash;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        // The cache is internally guarded, the metadata lock is not required.
+        deserialize(deserial, std::move(hash));
+    };
+
+    // The height may have been reorganized since the link was obtained.
+    if (!cache.read(hash, element_.link(), height, reader))
+        populate();
+}
+
+block_result::block_result(const const_element_type& element,
+    shared_mutex& metadata_mutex, const manager& index_manager,
+    data_chunk&& value)
+  : height_(0),
+    median_time_past_(0),
+    work_(0),
+    state_(block_state::missing),
+    checksum_(no_checksum),
+    tx_start_(0),
+    tx_count_(0),
+    element_(element),
+    index_manager_(index_manager),
+    metadata_mutex_(metadata_mutex)
+{
+    if (!element_)
+        return;
+
+    // The value is a private copy, the metadata lock is not required.
+    auto deserial = make_unsafe_deserializer(value.data());
+    deserialize(deserial, element_.key());
+}
+
+// private
+void block_result::populate()
+{
     auto hash = element_.key();
 
     // Each of the three atomic sets could be guarded independently.
@@ -71,18 +132,26 @@ block_result::block_result(const const_element_type& element,
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
         shared_lock lock(metadata_mutex_);
-        header_.from_data(deserial, std::move(hash), false);
-        median_time_past_ = deserial.read_4_bytes_little_endian();
-        height_ = deserial.read_4_bytes_little_endian();
-        state_ = deserial.read_byte();
-        checksum_ = deserial.read_4_bytes_little_endian();
-        tx_start_ = deserial.read_4_bytes_little_endian();
-        tx_count_ = deserial.read_2_bytes_little_endian();
+        deserialize(deserial, std::move(hash));
         ///////////////////////////////////////////////////////////////////////
     };
 
      // Reads are not deferred for updatable values as atomicity is required.
-     element.read(reader);
+     element_.read(reader);
+}
+
+// private
+void block_result::deserialize(byte_deserializer& deserial,
+    hash_digest&& hash)
+{
+    header_.from_data(deserial, std::move(hash), false);
+    median_time_past_ = deserial.read_4_bytes_little_endian();
+    height_ = deserial.read_4_bytes_little_endian();
+    work_ = to_uint256(deserial.read_hash());
+    state_ = deserial.read_byte();
+    checksum_ = deserial.read_4_bytes_little_endian();
+    tx_start_ = deserial.read_4_bytes_little_endian();
+    tx_count_ = deserial.read_2_bytes_little_endian();
 }
 
 block_result::operator bool() const
@@ -138,6 +207,11 @@ size_t block_result::height() const
     return height_;
 }
 
+uint256_t block_result::work() const
+{
+    return work_;
+}
+
 uint8_t block_result::state() const
 {
     return state_;
@@ -148,6 +222,16 @@ uint32_t block_result::checksum() const
     return checksum_;
 }
 
+// An invalid block checksum field stores a code, so it is not verified.
+bool block_result::verify(const chain::transaction::list& transactions) const
+{
+    if (checksum_ == no_checksum || is_failed(state_))
+        return true;
+
+    return transactions.size() == tx_count_ &&
+        database::checksum(transactions) == checksum_;
+}
+
 size_t block_result::transaction_count() const
 {
     return tx_count_;
@@ -29,6 +29,7 @@ static constexpr auto height_size = sizeof(uint32_t);
 static constexpr auto position_size = sizeof(uint16_t);
 static constexpr auto state_size = sizeof(uint8_t);
 static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto witness_size = sizeof(uint64_t);
 
 static constexpr auto index_spend_size = sizeof(uint8_t);
 ////static constexpr auto height_size = sizeof(uint32_t);
@@ -36,7 +37,7 @@ static constexpr auto value_size = sizeof(uint64_t);
 
 static constexpr auto spend_size = index_spend_size + height_size + value_size;
 static constexpr auto metadata_size = height_size + position_size +
-    state_size + median_time_past_size;
+    state_size + median_time_past_size + witness_size;
 
 static constexpr auto sequence_size = sizeof(uint32_t);
 
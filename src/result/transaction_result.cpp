@@ -35,6 +35,7 @@ static constexpr auto height_size = sizeof(uint32_t);
 static constexpr auto position_size = sizeof(uint16_t);
 static constexpr auto state_size = sizeof(uint8_t);
 static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto witness_size = sizeof(uint64_t);
 
 static constexpr auto index_spend_size = sizeof(uint8_t);
 ////static constexpr auto height_size = sizeof(uint32_t);
@@ -42,18 +43,21 @@ static constexpr auto value_size = sizeof(uint64_t);
 
 static constexpr auto spend_size = index_spend_size + height_size + value_size;
 static constexpr auto metadata_size = height_size + position_size +
-    state_size + median_time_past_size;
+    state_size + median_time_past_size + witness_size;
 
 const uint16_t transaction_result::unconfirmed = max_uint16;
 const uint32_t transaction_result::unverified = rule_fork::unverified;
+const file_offset transaction_result::unwitnessed = max_uint64;
 
 transaction_result::transaction_result(const const_element_type& element,
-    shared_mutex& metadata_mutex)
+    shared_mutex& metadata_mutex, const manager& witness_manager)
   : height_(0),
     position_(unconfirmed),
     state_(transaction_state::missing),
     median_time_past_(0),
+    witness_(unwitnessed),
     element_(element),
+    witness_manager_(witness_manager),
     metadata_mutex_(metadata_mutex)
 {
     if (!element_)
@@ -70,6 +74,9 @@ transaction_result::transaction_result(const const_element_type& element,
         state_ = static_cast<transaction_state>(deserial.read_byte());
         median_time_past_ = deserial.read_4_bytes_little_endian();
         ///////////////////////////////////////////////////////////////////////
+
+        // The witness link is const (not guarded).
+        witness_ = deserial.read_8_bytes_little_endian();
     };
 
     // Metadata reads not deferred for updatable values as atomicity required.
@@ -197,11 +204,27 @@ chain::transaction transaction_result::transaction(bool witness) const
     const auto reader = [&](byte_deserializer& deserial)
     {
         deserial.skip(metadata_size);
-        tx.from_data(deserial, std::move(key), false, witness);
+        tx.from_data(deserial, std::move(key), false, false);
     };
 
     element_.read(reader);
     tx.metadata.link = element_.link();
+
+    if (!witness || witness_ == unwitnessed)
+        return tx;
+
+    // Witnesses are stored in input order, one (possibly empty) per input.
+    // The tx hash excludes witness, so the cached hash remains valid.
+    const auto memory = witness_manager_.get(witness_);
+    auto deserial = make_unsafe_deserializer(memory->buffer());
+
+    for (auto& input: tx.inputs())
+    {
+        chain::witness stack;
+        stack.from_data(deserial, true);
+        input.set_witness(std::move(stack));
+    }
+
     return tx;
 }
 
@@ -29,14 +29,22 @@ settings::settings()
   : directory("blockchain"),
   
     index_addresses(true),
+    address_index_threads(0),
+    defer_address_index(false),
+    index_script_hashes(false),
+    index_spends(false),
+    cache_headers(false),
     flush_writes(false),
+    log_writes(false),
     file_growth_rate(5),
 
     // Hash table sizes (must be configured).
     block_table_buckets(0),
     transaction_table_buckets(0),
     address_table_buckets(0),
-    cache_capacity(0)
+    spend_table_buckets(0),
+    cache_capacity(0),
+    merkle_cache_capacity(0)
 {
 }
 
@@ -50,6 +58,7 @@ settings::settings(config::settings context)
             block_table_buckets = 650000;
             transaction_table_buckets = 110000000;
             address_table_buckets = 107000000;
+            spend_table_buckets = 250000000;
             break;
         }
 
@@ -59,6 +68,7 @@ settings::settings(config::settings context)
             block_table_buckets = 650000;
             transaction_table_buckets = 110000000;
             address_table_buckets = 107000000;
+            spend_table_buckets = 250000000;
             break;
         }
 
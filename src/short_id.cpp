@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/short_id.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+static constexpr uint64_t sip_v0 = 0x736f6d6570736575;
+static constexpr uint64_t sip_v1 = 0x646f72616e646f6d;
+static constexpr uint64_t sip_v2 = 0x6c7967656e657261;
+static constexpr uint64_t sip_v3 = 0x7465646279746573;
+static constexpr auto word_size = sizeof(uint64_t);
+
+static inline uint64_t rotate(uint64_t value, size_t bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2,
+    uint64_t& v3)
+{
+    v0 += v1; v1 = rotate(v1, 13); v1 ^= v0; v0 = rotate(v0, 32);
+    v2 += v3; v3 = rotate(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotate(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotate(v1, 17); v1 ^= v2; v2 = rotate(v2, 32);
+}
+
+// Read a partial or full little-endian word.
+static inline uint64_t read_word(const uint8_t* data, size_t size)
+{
+    uint64_t word = 0;
+
+    for (size_t byte = 0; byte < size; ++byte)
+        word |= static_cast<uint64_t>(data[byte]) << (8 * byte);
+
+    return word;
+}
+
+uint64_t siphash(const short_id_key& key, const uint8_t* data, size_t size)
+{
+    auto v0 = key.first ^ sip_v0;
+    auto v1 = key.second ^ sip_v1;
+    auto v2 = key.first ^ sip_v2;
+    auto v3 = key.second ^ sip_v3;
+
+    const auto tail = size % word_size;
+    const auto end = data + size - tail;
+
+    // Two compression rounds per word.
+    for (; data < end; data += word_size)
+    {
+        const auto word = read_word(data, word_size);
+        v3 ^= word;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= word;
+    }
+
+    // The final word carries the message length in its high byte.
+    const auto last = (static_cast<uint64_t>(size) << 56) |
+        read_word(data, tail);
+
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+
+    // Four finalization rounds.
+    v2 ^= 0xff;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint64_t short_id_nonce(const hash_digest& block_hash)
+{
+    return from_little_endian_unsafe<uint64_t>(block_hash.begin());
+}
+
+short_id_key to_short_id_key(const chain::header& header, uint64_t nonce)
+{
+    const auto digest = sha256_hash(build_chunk(
+    {
+        header.to_data(),
+        to_little_endian(nonce)
+    }));
+
+    return
+    {
+        from_little_endian_unsafe<uint64_t>(digest.begin()),
+        from_little_endian_unsafe<uint64_t>(digest.begin() + word_size)
+    };
+}
+
+mini_hash short_id(const short_id_key& key, const hash_digest& hash)
+{
+    mini_hash out;
+    const auto value = siphash(key, hash.data(), hash.size());
+    const auto bytes = to_little_endian(value);
+    std::copy(bytes.begin(), bytes.begin() + out.size(), out.begin());
+    return out;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/short_id_map.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/short_id.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+const file_offset short_id_map::not_found = max_uint64;
+
+short_id_map::short_id_map(const short_id_key& key)
+  : key_(key)
+{
+}
+
+size_t short_id_map::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return map_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Colliding short ids are retained as not_found so that a third collision
+// is not mistaken for a unique match.
+bool short_id_map::add(const hash_digest& hash, file_offset link)
+{
+    BITCOIN_ASSERT(link != not_found);
+    const auto key = to_key(short_id(key_, hash));
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto result = map_.emplace(key, link);
+
+    if (result.second || result.first->second == link)
+        return true;
+
+    result.first->second = not_found;
+    return false;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool short_id_map::find(file_offset& out_link, const mini_hash& id) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    const auto it = map_.find(to_key(id));
+
+    if (it == map_.end() || it->second == not_found)
+        return false;
+
+    out_link = it->second;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t short_id_map::match(link_list& out_links,
+    const short_id_list& ids) const
+{
+    size_t matched = 0;
+    out_links.clear();
+    out_links.reserve(ids.size());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    for (const auto& id: ids)
+    {
+        const auto it = map_.find(to_key(id));
+        const auto link = it == map_.end() ? not_found : it->second;
+        out_links.push_back(link);
+
+        if (link != not_found)
+            ++matched;
+    }
+
+    return matched;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+uint64_t short_id_map::to_key(const mini_hash& id)
+{
+    uint64_t key = 0;
+
+    for (size_t byte = 0; byte < id.size(); ++byte)
+        key |= static_cast<uint64_t>(id[byte]) << (8 * byte);
+
+    return key;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -18,10 +18,14 @@
  */
 #include <bitcoin/database/store.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -38,9 +42,17 @@ const std::string store::HEADER_INDEX = "header_index";
 const std::string store::BLOCK_INDEX = "block_index";
 const std::string store::BLOCK_TABLE = "block_table";
 const std::string store::TRANSACTION_INDEX = "transaction_index";
+const std::string store::SHORT_ID_INDEX = "short_id_index";
+const std::string store::TRANSACTION_HASH_INDEX = "transaction_hash_index";
+const std::string store::PENT_INDEX = "pent_index";
 const std::string store::TRANSACTION_TABLE = "transaction_table";
+const std::string store::TRANSACTION_WITNESS = "transaction_witness";
+const std::string store::UNDO_INDEX = "undo_index";
+const std::string store::UNDO_TABLE = "undo_table";
 const std::string store::ADDRESS_TABLE = "address_table";
 const std::string store::ADDRESS_ROWS = "address_rows";
+const std::string store::SPEND_TABLE = "spend_table";
+const std::string store::WRITE_LOG = "write_log";
 
 // Create a single file with one byte of arbitrary data.
 static bool create_file(const path& file_path)
@@ -62,10 +74,12 @@ static bool create_file(const path& file_path)
 // Construct.
 // ------------------------------------------------------------------------
 
-store::store(const path& prefix, bool with_indexes, bool flush_each_write)
+store::store(const path& prefix, bool with_indexes, bool flush_each_write,
+    bool log_each_write)
   : prefix_(prefix),
     with_indexes_(with_indexes),
     flush_each_write_(flush_each_write),
+    log_each_write_(log_each_write && !flush_each_write),
     flush_lock_(prefix / FLUSH_LOCK),
     exclusive_lock_(prefix / EXCLUSIVE_LOCK),
 
@@ -74,11 +88,27 @@ store::store(const path& prefix, bool with_indexes, bool flush_each_write)
     block_index(prefix / BLOCK_INDEX),
     block_table(prefix / BLOCK_TABLE),
     transaction_index(prefix / TRANSACTION_INDEX),
+    short_id_index(prefix / SHORT_ID_INDEX),
+    transaction_hash_index(prefix / TRANSACTION_HASH_INDEX),
+    pent_index(prefix / PENT_INDEX),
     transaction_table(prefix / TRANSACTION_TABLE),
+    transaction_witness(prefix / TRANSACTION_WITNESS),
+    undo_index(prefix / UNDO_INDEX),
+    undo_table(prefix / UNDO_TABLE),
 
     // Optional indexes.
     address_table(prefix / ADDRESS_TABLE),
-    address_rows(prefix / ADDRESS_ROWS)
+    address_rows(prefix / ADDRESS_ROWS),
+    spend_table(prefix / SPEND_TABLE),
+
+    // Logged files are identified by position, so the order is persistent.
+    log_(prefix / WRITE_LOG,
+    {
+        header_index, block_index, block_table, transaction_index,
+        short_id_index, transaction_hash_index, pent_index,
+        transaction_table, transaction_witness, undo_index, undo_table,
+        address_table, address_rows, spend_table
+    })
 {
 }
 
@@ -96,7 +126,13 @@ bool store::create()
         create_file(block_index) &&
         create_file(block_table) &&
         create_file(transaction_index) &&
-        create_file(transaction_table);
+        create_file(short_id_index) &&
+        create_file(transaction_hash_index) &&
+        create_file(pent_index) &&
+        create_file(transaction_table) &&
+        create_file(transaction_witness) &&
+        create_file(undo_index) &&
+        create_file(undo_table);
 
     if (!with_indexes_)
         return created;
@@ -104,28 +140,49 @@ bool store::create()
     return
         created &&
         create_file(address_table) &&
-        create_file(address_rows);
+        create_file(address_rows) &&
+        create_file(spend_table);
 }
 
+// A logged store is locked only during write sequences, as with write
+// flushing. Outside of a sequence all in-place writes are in the log, so a
+// logged store is replayed on open, which recovers writes lost to a crash.
 bool store::open()
 {
-    return exclusive_lock_.lock() && flush_lock_.try_lock() &&
-        (flush_each_write() || flush_lock_.lock_shared());
+    const auto locked = exclusive_lock_.lock() && flush_lock_.try_lock();
+
+    if (log_each_write() && !(locked && log_.open() && replay()))
+        return false;
+
+    return locked && (flush_each_write() || log_each_write() ||
+        flush_lock_.lock_shared());
 }
 
 bool store::close()
 {
-    return (flush_each_write() || flush_lock_.unlock_shared()) &&
-        exclusive_lock_.unlock();
+    // The files are closed (flushed) before the store, so the log is reset.
+    if (log_each_write() && !(log_.reset() && log_.close()))
+        return false;
+
+    return (flush_each_write() || log_each_write() ||
+        flush_lock_.unlock_shared()) && exclusive_lock_.unlock();
 }
 
 bool store::begin_write() const
 {
+    // The flush lock is held from the first to the last overlapping sequence.
+    if (log_each_write())
+        return log_.begin([this]() { return flush_lock_.lock_shared(); });
+
     return !flush_each_write() || flush_lock_.lock_shared();
 }
 
 bool store::end_write() const
 {
+    if (log_each_write())
+        return log_.end([this]() { return flush(); },
+            [this]() { return flush_lock_.unlock_shared(); });
+
     return !flush_each_write() || (flush() && flush_lock_.unlock_shared());
 }
 
@@ -134,5 +191,55 @@ bool store::flush_each_write() const
     return flush_each_write_;
 }
 
+bool store::log_each_write() const
+{
+    return log_each_write_;
+}
+
+// protected
+write_log& store::write_logger()
+{
+    return log_;
+}
+
+// private
+// Apply the logged writes to the files, which are then flushed and closed.
+bool store::replay()
+{
+    const auto& paths = log_.files();
+    std::vector<std::shared_ptr<file_storage>> files(paths.size());
+
+    const auto handler = [&](size_t index, file_offset offset,
+        const data_chunk& data)
+    {
+        auto& file = files[index];
+
+        if (!file)
+        {
+            file = std::make_shared<file_storage>(paths[index]);
+
+            if (!file->open())
+                return false;
+        }
+
+        // Writes beyond a file truncated on close are beyond its records.
+        if (offset + data.size() > file->size())
+            return true;
+
+        // The accessor must remain in scope until the end of the block.
+        const auto memory = file->access();
+        std::copy(data.begin(), data.end(), memory->buffer() + offset);
+        return true;
+    };
+
+    auto replayed = log_.replay(handler);
+
+    for (const auto& file: files)
+        if (file)
+            replayed &= file->close();
+
+    return replayed && log_.reset();
+}
+
 } // namespace database
 } // namespace libbitcoin
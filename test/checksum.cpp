@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(checksum_tests)
+
+BOOST_AUTO_TEST_CASE(checksum__crc32c__empty__zero)
+{
+    BOOST_REQUIRE_EQUAL(crc32c(0, nullptr, 0), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(checksum__crc32c__check_string__expected)
+{
+    const std::string text("123456789");
+    const auto data = reinterpret_cast<const uint8_t*>(text.data());
+    BOOST_REQUIRE_EQUAL(crc32c(0, data, text.size()), 0xe3069283);
+}
+
+BOOST_AUTO_TEST_CASE(checksum__crc32c__zeros__expected)
+{
+    const data_chunk data(32, 0x00);
+    BOOST_REQUIRE_EQUAL(crc32c(0, data.data(), data.size()), 0x8a9136aa);
+}
+
+BOOST_AUTO_TEST_CASE(checksum__crc32c__ones__expected)
+{
+    const data_chunk data(32, 0xff);
+    BOOST_REQUIRE_EQUAL(crc32c(0, data.data(), data.size()), 0x62a8ab43);
+}
+
+BOOST_AUTO_TEST_CASE(checksum__crc32c__extended__same_as_whole)
+{
+    const std::string text("123456789");
+    const auto data = reinterpret_cast<const uint8_t*>(text.data());
+    const auto partial = crc32c(0, data, 4);
+    BOOST_REQUIRE_EQUAL(crc32c(partial, data + 4, 5), 0xe3069283);
+}
+
+BOOST_AUTO_TEST_CASE(checksum__checksum__empty__zero)
+{
+    BOOST_REQUIRE_EQUAL(checksum({}), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(checksum__checksum__transactions__crc32c_of_wire_serialization)
+{
+    const auto& tx = block::genesis_mainnet().transactions().front();
+    const transaction::list txs{ tx, tx };
+    const auto data = build_chunk({ tx.to_data(true, true), tx.to_data(true, true) });
+    BOOST_REQUIRE_EQUAL(checksum(txs), crc32c(0, data.data(), data.size()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,21 +1,119 @@
-/////**
-//// * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
-//// *
-//// * This file is part of libbitcoin.
-//// *
-//// * This program is free software: you can redistribute it and/or modify
-//// * it under the terms of the GNU Affero General Public License as published by
-//// * the Free Software Foundation, either version 3 of the License, or
-//// * (at your option) any later version.
-//// *
-//// * This program is distributed in the hope that it will be useful,
-//// * but WITHOUT ANY WARRANTY; without even the implied warranty of
-//// * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-//// * GNU Affero General Public License for more details.
-//// *
-//// * You should have received a copy of the GNU Affero General Public License
-//// * along with this program.  If not, see <http://www.gnu.org/licenses/>.
-//// */
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <bitcoin/database.hpp>
+#include "utility/utility.hpp"
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::database;
+
+#define DIRECTORY "data_base"
+#define TRANSACTION1 "0100000001537c9d05b5f7d67b09e5108e3bd5e466909cc9403ddd98bc42973f366fe729410600000000ffffffff0163000000000000001976a914fe06e7b4c88a719e92373de489c08244aee4520b88ac00000000"
+#define TRANSACTION2 "010000000147811c3fc0c0e750af5d0ea7343b16ea2d0c291c002e3db778669216eb689de80000000000ffffffff0118ddf505000000001976a914575c2f0ea88fcbad2389a372d942dea95addc25b88ac00000000"
+
+struct data_base_directory_setup_fixture
+{
+    data_base_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(data_base_store_tests, data_base_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(data_base__store__concurrent_with_duplicates__one_stored_each)
+{
+    transaction tx1;
+    data_chunk wire_tx1;
+    BOOST_REQUIRE(decode_base16(wire_tx1, TRANSACTION1));
+    BOOST_REQUIRE(tx1.from_data(wire_tx1));
+
+    transaction tx2;
+    data_chunk wire_tx2;
+    BOOST_REQUIRE(decode_base16(wire_tx2, TRANSACTION2));
+    BOOST_REQUIRE(tx2.from_data(wire_tx2));
+
+    database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.index_addresses = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+
+    data_base instance(settings);
+    BOOST_REQUIRE(instance.create(block::genesis_mainnet()));
+
+    // Callers are grouped as they queue, so groups contain duplicates.
+    static constexpr size_t callers = 16;
+    std::vector<code> results(callers);
+    std::vector<std::thread> threads;
+
+    for (size_t caller = 0; caller < callers; ++caller)
+        threads.emplace_back([&, caller]()
+        {
+            results[caller] = instance.store(caller % 2 ? tx2 : tx1, 0);
+        });
+
+    for (auto& thread: threads)
+        thread.join();
+
+    size_t stored1 = 0;
+    size_t stored2 = 0;
+
+    for (size_t caller = 0; caller < callers; ++caller)
+    {
+        if (results[caller])
+        {
+            BOOST_REQUIRE_EQUAL(results[caller], error::unspent_duplicate);
+            continue;
+        }
+
+        ++(caller % 2 ? stored2 : stored1);
+    }
+
+    // Duplicates are rejected only in debug builds, as with ungrouped stores.
+#ifndef NDEBUG
+    BOOST_REQUIRE_EQUAL(stored1, 1u);
+    BOOST_REQUIRE_EQUAL(stored2, 1u);
+#else
+    BOOST_REQUIRE_EQUAL(stored1, callers / 2u);
+    BOOST_REQUIRE_EQUAL(stored2, callers / 2u);
+#endif
+
+    const auto result1 = instance.transactions().get(tx1.hash());
+    BOOST_REQUIRE(result1);
+    BOOST_REQUIRE(result1.transaction().hash() == tx1.hash());
+
+    const auto result2 = instance.transactions().get(tx2.hash());
+    BOOST_REQUIRE(result2);
+    BOOST_REQUIRE(result2.transaction().hash() == tx2.hash());
+
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 ////#include <boost/test/unit_test.hpp>
 ////
 ////#include <future>
@@ -26,6 +26,7 @@ using namespace boost::system;
 using namespace boost::filesystem;
 using namespace bc;
 using namespace bc::chain;
+using namespace bc::machine;
 using namespace bc::database;
 
 #define DIRECTORY "address_database"
@@ -65,13 +66,13 @@ BOOST_AUTO_TEST_CASE(address_database__test)
     address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
     BOOST_REQUIRE(db.create());
 
-    db.store(key1, output_11);
-    db.store(key1, output_12);
-    db.store(key1, output_13);
-    db.store(key1, input_11);
-    db.store(key1, input_13);
-    db.store(key2, output_21);
-    db.store(key2, output_22);
+    db.store(key1, output_11, 1, 0);
+    db.store(key1, output_12, 2, 0);
+    db.store(key1, output_13, 3, 0);
+    db.store(key1, input_11, 4, 0);
+    db.store(key1, input_13, 5, 0);
+    db.store(key2, output_21, 6, 0);
+    db.store(key2, output_22, 7, 0);
 
     auto result1 = db.get(key1);
     BOOST_REQUIRE(result1);
@@ -119,7 +120,7 @@ BOOST_AUTO_TEST_CASE(address_database__test)
     auto entry_2_1 = *it2;
     BOOST_REQUIRE(entry_2_1.is_output());
 
-    db.store(key2, input_22);
+    db.store(key2, input_22, 8, 0);
     auto result3 = db.get(key2);
     auto it3 = result3.begin();
 
@@ -153,13 +154,13 @@ BOOST_AUTO_TEST_CASE(address_database__test)
     auto entry_4_1 = *it4;
     BOOST_REQUIRE(entry_4_1.is_output());
 
-    db.store(key3, output_31);
+    db.store(key3, output_31, 9, 0);
     auto result5 = db.get(key3);
     auto it5 = result5.begin();
     BOOST_REQUIRE(it5 != result5.end());
     BOOST_REQUIRE(++it5 == result5.end());
 
-    db.store(key4, output_41);
+    db.store(key4, output_41, 10, 0);
     auto result6 = db.get(key4);
     auto it6 = result6.begin();
     BOOST_REQUIRE(it6 != result6.end());
@@ -178,4 +179,359 @@ BOOST_AUTO_TEST_CASE(address_database__test)
     db.commit();
 }
 
+BOOST_AUTO_TEST_CASE(address_database__store_pop__many_pages__newest_first)
+{
+    const short_hash key = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const auto rows = 3 * address_database::page_capacity + 5;
+    const auto payment = [](size_t row)
+    {
+        return payment_record{ row, 0, row, true };
+    };
+
+    test::create(DIRECTORY "/address_table");
+    test::create(DIRECTORY "/address_rows");
+    address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+    BOOST_REQUIRE(db.create());
+    BOOST_REQUIRE(!db.get(key));
+
+    for (size_t row = 0; row < rows; ++row)
+        db.store(key, payment(row), row, 0);
+
+    const auto verify = [&](size_t count)
+    {
+        const auto result = db.get(key);
+        auto expected = count;
+
+        for (const auto& entry: result)
+            BOOST_REQUIRE(entry == payment(--expected));
+
+        BOOST_REQUIRE_EQUAL(expected, 0u);
+    };
+
+    verify(rows);
+
+    // Pop across page boundaries, unlinking emptied pages.
+    for (size_t row = 0; row < address_database::page_capacity + 7; ++row)
+        BOOST_REQUIRE(db.pop(key));
+
+    const auto remaining = rows - address_database::page_capacity - 7;
+    verify(remaining);
+
+    // Store into the partially popped newest page.
+    db.store(key, payment(remaining), remaining, 0);
+    verify(remaining + 1);
+
+    for (size_t row = 0; row <= remaining; ++row)
+        BOOST_REQUIRE(db.pop(key));
+
+    BOOST_REQUIRE(!db.pop(key));
+    BOOST_REQUIRE(!db.get(key));
+    BOOST_REQUIRE(db.get(key).begin() == db.get(key).end());
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(address_database__get__height_range_with_cursor__resumed_newest_first)
+{
+    const short_hash key = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const auto payment = [](size_t row)
+    {
+        return payment_record{ row, 0, row, true };
+    };
+
+    test::create(DIRECTORY "/address_table");
+    test::create(DIRECTORY "/address_rows");
+    address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+    BOOST_REQUIRE(db.create());
+
+    auto cursor = address_database::first_cursor;
+    BOOST_REQUIRE(db.get(key, 0, 100, 10, cursor).empty());
+    BOOST_REQUIRE(cursor == address_database::last_cursor);
+
+    for (size_t row = 0; row < 100; ++row)
+        db.store(key, payment(row), row, 0);
+
+    // Rows in [10, 59] are returned newest first in pages of 15.
+    size_t expected = 59;
+    cursor = address_database::first_cursor;
+
+    while (cursor != address_database::last_cursor)
+    {
+        const auto payments = db.get(key, 10, 59, 15, cursor);
+        BOOST_REQUIRE(!payments.empty());
+        BOOST_REQUIRE(payments.size() <= 15u);
+
+        for (const auto& entry: payments)
+            BOOST_REQUIRE(entry == payment(expected--));
+    }
+
+    BOOST_REQUIRE_EQUAL(expected, 9u);
+
+    // A resumed query with no remaining rows in range completes empty.
+    cursor = address_database::first_cursor;
+    const auto newest = db.get(key, 90, 95, 6, cursor);
+    BOOST_REQUIRE_EQUAL(newest.size(), 6u);
+    BOOST_REQUIRE(newest.front() == payment(95));
+    BOOST_REQUIRE(newest.back() == payment(90));
+    BOOST_REQUIRE(db.get(key, 90, 95, 6, cursor).empty());
+    BOOST_REQUIRE(cursor == address_database::last_cursor);
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(address_database__get__newest_page_below_range__walk_stopped)
+{
+    const short_hash key = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const auto payment = [](size_t row)
+    {
+        return payment_record{ row, 0, row, true };
+    };
+
+    test::create(DIRECTORY "/address_table");
+    test::create(DIRECTORY "/address_rows");
+    address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+    BOOST_REQUIRE(db.create());
+
+    // The first (oldest) page holds two rows, the rows above are in the
+    // newest page. Heights are not in block order, so that rows of the
+    // oldest page are in range only if the walk is not stopped at the newest.
+    db.store(key, payment(0), 80, 0);
+    db.store(key, payment(1), 81, 0);
+    db.store(key, payment(2), 10, 0);
+    db.store(key, payment(3), 11, 0);
+
+    auto cursor = address_database::first_cursor;
+    BOOST_REQUIRE_EQUAL(db.get(key, 0, 100, 10, cursor).size(), 4u);
+    BOOST_REQUIRE(cursor == address_database::last_cursor);
+
+    // The newest page is below the range, so the oldest page is not read.
+    cursor = address_database::first_cursor;
+    BOOST_REQUIRE(db.get(key, 50, 100, 10, cursor).empty());
+    BOOST_REQUIRE(cursor == address_database::last_cursor);
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(address_database__get_summary__store_pop__maintained)
+{
+    const short_hash key = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const auto rows = address_database::page_capacity + 3;
+    const auto payment = [](size_t row)
+    {
+        // Even rows are outputs and odd rows are inputs.
+        return payment_record{ row, 0, row, row % 2 == 0 };
+    };
+
+    test::create(DIRECTORY "/address_table");
+    test::create(DIRECTORY "/address_rows");
+    address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+    BOOST_REQUIRE(db.create());
+
+    address_database::summary summary;
+    BOOST_REQUIRE(!db.get_summary(summary, key));
+
+    uint64_t received = 0;
+    uint64_t spent = 0;
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        db.store(key, payment(row), 10 + row, 100 * row);
+        (row % 2 == 0 ? received : spent) += 100 * row;
+    }
+
+    BOOST_REQUIRE(db.get_summary(summary, key));
+    BOOST_REQUIRE_EQUAL(summary.received, received);
+    BOOST_REQUIRE_EQUAL(summary.spent, spent);
+    BOOST_REQUIRE_EQUAL(summary.rows, rows);
+    BOOST_REQUIRE_EQUAL(summary.first_height, 10u);
+    BOOST_REQUIRE_EQUAL(summary.last_height, 10u + rows - 1u);
+
+    // Pop across a page boundary, reversing each row.
+    for (size_t row = rows; row > 2; --row)
+    {
+        BOOST_REQUIRE(db.pop(key));
+        ((row - 1) % 2 == 0 ? received : spent) -= 100 * (row - 1);
+        BOOST_REQUIRE(db.get_summary(summary, key));
+        BOOST_REQUIRE_EQUAL(summary.received, received);
+        BOOST_REQUIRE_EQUAL(summary.spent, spent);
+        BOOST_REQUIRE_EQUAL(summary.rows, row - 1u);
+        BOOST_REQUIRE_EQUAL(summary.first_height, 10u);
+        BOOST_REQUIRE_EQUAL(summary.last_height, 10u + row - 2u);
+    }
+
+    BOOST_REQUIRE(db.pop(key));
+    BOOST_REQUIRE(db.pop(key));
+    BOOST_REQUIRE(db.get_summary(summary, key));
+    BOOST_REQUIRE_EQUAL(summary.received, 0u);
+    BOOST_REQUIRE_EQUAL(summary.spent, 0u);
+    BOOST_REQUIRE_EQUAL(summary.rows, 0u);
+    BOOST_REQUIRE_EQUAL(summary.first_height, 0u);
+    BOOST_REQUIRE_EQUAL(summary.last_height, 0u);
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(address_database__to_key__witness_outputs__typed_keys)
+{
+    typedef address_database::address_type address_type;
+    const data_chunk program20(short_hash_size, 0x42);
+    const data_chunk program32(hash_size, 0x42);
+    const script p2wpkh(operation::list{ operation(opcode::push_size_0), operation(program20) });
+    const script p2wsh(operation::list{ operation(opcode::push_size_0), operation(program32) });
+    const script p2tr(operation::list{ operation(opcode::push_positive_1), operation(program32) });
+    const script v1_short(operation::list{ operation(opcode::push_positive_1), operation(program20) });
+    const script not_witness(operation::list{ operation(program20), operation(opcode::drop) });
+
+    short_hash key;
+    BOOST_REQUIRE(address_database::to_key(key, p2wpkh));
+    BOOST_REQUIRE(key == address_database::to_key(address_type::witness_key_hash, program20));
+    BOOST_REQUIRE(key != to_array<short_hash_size>(program20));
+
+    BOOST_REQUIRE(address_database::to_key(key, p2wsh));
+    BOOST_REQUIRE(key == address_database::to_key(address_type::witness_script_hash, program32));
+
+    BOOST_REQUIRE(address_database::to_key(key, p2tr));
+    BOOST_REQUIRE(key == address_database::to_key(address_type::witness_taproot, program32));
+    BOOST_REQUIRE(key != address_database::to_key(address_type::witness_script_hash, program32));
+
+    BOOST_REQUIRE(!address_database::to_key(key, v1_short));
+    BOOST_REQUIRE(!address_database::to_key(key, not_witness));
+}
+
+BOOST_AUTO_TEST_CASE(address_database__to_script_key__non_standard_script__typed_sha256_key)
+{
+    typedef address_database::address_type address_type;
+    const data_chunk program20(short_hash_size, 0x42);
+    const script not_standard(operation::list{ operation(program20), operation(opcode::drop) });
+    const auto script_hash = sha256_hash(not_standard.to_data(false));
+
+    const auto key = address_database::to_script_key(not_standard);
+    BOOST_REQUIRE(key == address_database::to_script_key(script_hash));
+    BOOST_REQUIRE(key == address_database::to_key(address_type::script_hash, script_hash));
+    BOOST_REQUIRE(key != address_database::to_key(address_type::witness_script_hash, script_hash));
+}
+
+BOOST_AUTO_TEST_CASE(address_database__set_indexed__reopen__persisted)
+{
+    test::create(DIRECTORY "/address_table");
+    test::create(DIRECTORY "/address_rows");
+
+    {
+        address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+        BOOST_REQUIRE(db.create());
+        BOOST_REQUIRE_EQUAL(db.indexed(), 0u);
+
+        db.set_indexed(42);
+        BOOST_REQUIRE_EQUAL(db.indexed(), 42u);
+        db.commit();
+        BOOST_REQUIRE(db.close());
+    }
+
+    address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+    BOOST_REQUIRE(db.open());
+    BOOST_REQUIRE_EQUAL(db.indexed(), 42u);
+}
+
+BOOST_AUTO_TEST_CASE(address_database__store__row_list_after_row__newest_first)
+{
+    const short_hash key = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const auto rows = 2 * address_database::page_capacity + 3;
+    const auto payment = [](size_t row)
+    {
+        return payment_record{ row, 0, row, true };
+    };
+
+    test::create(DIRECTORY "/address_table");
+    test::create(DIRECTORY "/address_rows");
+    address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+    BOOST_REQUIRE(db.create());
+
+    db.store(key, payment(0), 0, 1);
+
+    address_database::row_list history;
+    for (size_t row = 1; row < rows; ++row)
+        history.push_back({ payment(row), row, 1 });
+
+    db.store(key, history);
+    db.store(key, address_database::row_list{});
+
+    auto expected = rows;
+    for (const auto& entry: db.get(key))
+        BOOST_REQUIRE(entry == payment(--expected));
+
+    BOOST_REQUIRE_EQUAL(expected, 0u);
+
+    address_database::summary summary;
+    BOOST_REQUIRE(db.get_summary(summary, key));
+    BOOST_REQUIRE_EQUAL(summary.received, rows);
+    BOOST_REQUIRE_EQUAL(summary.rows, rows);
+    BOOST_REQUIRE_EQUAL(summary.first_height, 0u);
+    BOOST_REQUIRE_EQUAL(summary.last_height, rows - 1u);
+
+    // Pops cross the pages of the bulk rows.
+    for (size_t row = 1; row < rows; ++row)
+        BOOST_REQUIRE(db.pop(key));
+
+    BOOST_REQUIRE(db.get_summary(summary, key));
+    BOOST_REQUIRE_EQUAL(summary.rows, 1u);
+    BOOST_REQUIRE_EQUAL(summary.last_height, 0u);
+    BOOST_REQUIRE(*db.get(key).begin() == payment(0));
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(address_database__store_pop__wide_deltas__round_trip)
+{
+    const short_hash key = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const size_t rows = 20;
+
+    // Links and heights alternate between small and large, inputs carry
+    // full checksums and outputs carry values not implied by their data.
+    const auto payment = [](size_t row)
+    {
+        const uint64_t link = row % 2 == 0 ? row : max_uint64 - row;
+        const auto output = row % 3 != 0;
+        const auto data = output ? row : max_uint64 - row;
+        return payment_record{ link, static_cast<uint32_t>(row), data, output };
+    };
+    const auto height = [](size_t row)
+    {
+        return row % 2 == 0 ? max_uint32 - row : row;
+    };
+
+    test::create(DIRECTORY "/address_table");
+    test::create(DIRECTORY "/address_rows");
+    address_database db(DIRECTORY "/address_table", DIRECTORY "/address_rows", 1000, 50);
+    BOOST_REQUIRE(db.create());
+
+    for (size_t row = 0; row < rows; ++row)
+        db.store(key, payment(row), height(row), row + 1u);
+
+    // Replace the newest rows, reusing the space released by pops.
+    BOOST_REQUIRE(db.pop(key));
+    BOOST_REQUIRE(db.pop(key));
+    db.store(key, payment(rows - 2u), height(rows - 2u), rows - 1u);
+    db.store(key, payment(rows - 1u), height(rows - 1u), rows);
+
+    auto expected = rows;
+    for (const auto& entry: db.get(key))
+        BOOST_REQUIRE(entry == payment(--expected));
+
+    BOOST_REQUIRE_EQUAL(expected, 0u);
+
+    // Only the rows of small heights are in range.
+    auto cursor = address_database::first_cursor;
+    const auto payments = db.get(key, 0, rows, rows, cursor);
+    BOOST_REQUIRE_EQUAL(payments.size(), rows / 2u);
+    BOOST_REQUIRE(payments.front() == payment(rows - 1u));
+    BOOST_REQUIRE(payments.back() == payment(1));
+
+    address_database::summary summary;
+    BOOST_REQUIRE(db.get_summary(summary, key));
+    BOOST_REQUIRE_EQUAL(summary.rows, rows);
+    BOOST_REQUIRE_EQUAL(summary.last_height, height(rows - 1u));
+
+    db.commit();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
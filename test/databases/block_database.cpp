@@ -44,6 +44,29 @@ struct block_database_directory_setup_fixture
     block_database_directory_setup_fixture()
     {
         test::clear_path(DIRECTORY);
+        test::create(DIRECTORY "/block_table");
+        test::create(DIRECTORY "/header_index");
+        test::create(DIRECTORY "/block_index");
+        test::create(DIRECTORY "/tx_index");
+        test::create(DIRECTORY "/short_id_index");
+        test::create(DIRECTORY "/tx_hash_index");
+        test::create(DIRECTORY "/pent_index");
+    }
+};
+
+// A block database of the files created by the fixture.
+class block_database_accessor
+  : public block_database
+{
+public:
+    block_database_accessor(bool cache_headers=false,
+        size_t merkle_capacity=0)
+      : block_database(DIRECTORY "/block_table", DIRECTORY "/header_index",
+            DIRECTORY "/block_index", DIRECTORY "/tx_index",
+            DIRECTORY "/short_id_index", DIRECTORY "/tx_hash_index",
+            DIRECTORY "/pent_index", 1000, 50, cache_headers,
+            merkle_capacity)
+    {
     }
 };
 
@@ -143,16 +166,7 @@ BOOST_AUTO_TEST_CASE(block_database__test)
     });
     const auto h5b = block5b.hash();
 
-    const auto block_table = DIRECTORY "/block_table";
-    const auto header_index = DIRECTORY "/header_index";
-    const auto block_index = DIRECTORY "/block_index";
-    const auto tx_index = DIRECTORY "/tx_index";
-
-    test::create(block_table);
-    test::create(header_index);
-    test::create(block_index);
-    test::create(tx_index);
-    block_database db(block_table, header_index, block_index, tx_index, 1000, 50);
+    block_database_accessor db;
     BOOST_REQUIRE(db.create());
 
     size_t height;
@@ -242,4 +256,396 @@ BOOST_AUTO_TEST_CASE(block_database__test)
     db.commit();
 }
 
+BOOST_AUTO_TEST_CASE(block_database__transaction_link__confirmed__expected)
+{
+    auto block0 = block::genesis_mainnet();
+    block0.set_transactions(
+    {
+        random_tx(0),
+        random_tx(1)
+    });
+
+    block block1;
+    block1.set_header(block0.header());
+    block1.header().set_nonce(4);
+    block1.set_transactions(
+    {
+        random_tx(2),
+        random_tx(3),
+        random_tx(4)
+    });
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.create());
+
+    db.push(block0, 0, 0);
+    db.push(block1, 1, 0);
+
+    file_offset link;
+    BOOST_REQUIRE(db.transaction_link(link, 0, 1));
+    BOOST_REQUIRE_EQUAL(link, 1u);
+    BOOST_REQUIRE(db.transaction_link(link, 1, 0));
+    BOOST_REQUIRE_EQUAL(link, 2u);
+    BOOST_REQUIRE(db.transaction_link(link, 1, 2));
+    BOOST_REQUIRE_EQUAL(link, 4u);
+
+    // Position and height out of range.
+    BOOST_REQUIRE(!db.transaction_link(link, 1, 3));
+    BOOST_REQUIRE(!db.transaction_link(link, 2, 0));
+
+    // Not in the header index.
+    BOOST_REQUIRE(!db.transaction_link(link, 0, 0, false));
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__get__cached_headers__expected)
+{
+    const auto header0 = block::genesis_mainnet().header();
+    auto header1 = header0;
+    header1.set_nonce(4);
+    auto header2 = header0;
+    header2.set_nonce(110);
+
+    block_database_accessor db(true);
+    BOOST_REQUIRE(db.create());
+
+    db.push(header0, 0);
+    db.push(header1, 1);
+
+    header_columns::column timestamps;
+    BOOST_REQUIRE_EQUAL(db.columns().size(), 2u);
+    BOOST_REQUIRE(db.columns().timestamps(timestamps, 0, 2));
+    BOOST_REQUIRE_EQUAL(timestamps[1], header1.timestamp());
+
+    const auto result1 = db.get(1, false);
+    BOOST_REQUIRE(result1);
+    BOOST_REQUIRE(result1.hash() == header1.hash());
+    BOOST_REQUIRE_EQUAL(result1.height(), 1u);
+    BOOST_REQUIRE(is_indexed(result1.state()));
+    BOOST_REQUIRE(is_pent(result1.state()));
+
+    // State changes are reflected in the cache.
+    BOOST_REQUIRE(db.validate(header0.hash(), true));
+    const auto result0 = db.get(0, false);
+    BOOST_REQUIRE(result0);
+    BOOST_REQUIRE(result0.hash() == header0.hash());
+    BOOST_REQUIRE(is_valid(result0.state()));
+
+    // Popped headers are removed from the cache.
+    BOOST_REQUIRE(db.unconfirm(header1.hash(), 1, false));
+    BOOST_REQUIRE(!db.get(1, false));
+    BOOST_REQUIRE_EQUAL(db.columns().size(), 1u);
+
+    db.push(header2, 1);
+    const auto result2 = db.get(1, false);
+    BOOST_REQUIRE(result2);
+    BOOST_REQUIRE(result2.hash() == header2.hash());
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__columns__cached_headers__median_time_past)
+{
+    header_columns::column median_time_pasts;
+
+    {
+        block_database_accessor db(true);
+        BOOST_REQUIRE(db.create());
+
+        // Pushed headers carry no median time past, timestamps are unordered.
+        auto header = block::genesis_mainnet().header();
+
+        for (uint32_t height = 0; height < 14; ++height)
+        {
+            header.set_timestamp(1000 + (height * 7) % 13 * 10);
+            db.push(header, height);
+        }
+
+        BOOST_REQUIRE(db.columns().median_time_pasts(median_time_pasts, 12, 2));
+        BOOST_REQUIRE_EQUAL(median_time_pasts[0], 1070u);
+        BOOST_REQUIRE_EQUAL(median_time_pasts[1], 1060u);
+
+        db.commit();
+        BOOST_REQUIRE(db.close());
+    }
+
+    // Open repopulates the columns from the header index.
+    block_database_accessor db(true);
+    BOOST_REQUIRE(db.open());
+    BOOST_REQUIRE(db.columns().median_time_pasts(median_time_pasts, 12, 2));
+    BOOST_REQUIRE_EQUAL(median_time_pasts[0], 1070u);
+    BOOST_REQUIRE_EQUAL(median_time_pasts[1], 1060u);
+}
+
+BOOST_AUTO_TEST_CASE(block_database__push__header_list__indexed)
+{
+    const auto header0 = std::make_shared<const message::header>(
+        block::genesis_mainnet().header());
+    auto header1 = std::make_shared<message::header>(*header0);
+    header1->set_nonce(4);
+    auto header2 = std::make_shared<message::header>(*header0);
+    header2->set_nonce(110);
+    const message::header::const_ptr_list headers{ header0, header1, header2 };
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.create());
+
+    db.push(headers, 0);
+
+    size_t top;
+    BOOST_REQUIRE(db.top(top, false));
+    BOOST_REQUIRE_EQUAL(top, 2u);
+    BOOST_REQUIRE(!db.top(top, true));
+
+    for (size_t height = 0; height < headers.size(); ++height)
+    {
+        const auto result = db.get(height, false);
+        BOOST_REQUIRE(result);
+        BOOST_REQUIRE(result.hash() == headers[height]->hash());
+        BOOST_REQUIRE_EQUAL(result.height(), height);
+        BOOST_REQUIRE(is_indexed(result.state()));
+    }
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__short_ids__populated__expected)
+{
+    auto block0 = block::genesis_mainnet();
+    block0.set_transactions(
+    {
+        random_tx(0),
+        random_tx(1)
+    });
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.create());
+
+    uint64_t nonce;
+    block_database::short_id_list ids;
+    BOOST_REQUIRE(!db.short_ids(nonce, ids, block0.hash()));
+
+    db.push(block0, 0, 0);
+    BOOST_REQUIRE(db.short_ids(nonce, ids, block0.hash()));
+    BOOST_REQUIRE_EQUAL(nonce, short_id_nonce(block0.hash()));
+    BOOST_REQUIRE_EQUAL(ids.size(), 2u);
+
+    const auto key = to_short_id_key(block0.header(), nonce);
+    const auto& txs = block0.transactions();
+    BOOST_REQUIRE(ids[0] == short_id(key, txs[0].hash(true)));
+    BOOST_REQUIRE(ids[1] == short_id(key, txs[1].hash(true)));
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__transaction_hashes__populated__expected)
+{
+    auto block0 = block::genesis_mainnet();
+    block0.set_transactions(
+    {
+        random_tx(0),
+        random_tx(1),
+        random_tx(2)
+    });
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.create());
+
+    hash_list hashes;
+    BOOST_REQUIRE(!db.transaction_hashes(hashes, block0.hash()));
+
+    db.push(block0, 0, 0);
+    BOOST_REQUIRE(db.transaction_hashes(hashes, block0.hash()));
+    BOOST_REQUIRE_EQUAL(hashes.size(), 3u);
+
+    const auto& txs = block0.transactions();
+    BOOST_REQUIRE(hashes[0] == txs[0].hash());
+    BOOST_REQUIRE(hashes[1] == txs[1].hash());
+    BOOST_REQUIRE(hashes[2] == txs[2].hash());
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__merkle_branch__populated__folds_to_merkle_root)
+{
+    auto block0 = block::genesis_mainnet();
+    block0.set_transactions(
+    {
+        random_tx(0),
+        random_tx(1),
+        random_tx(2)
+    });
+
+    block_database_accessor db(false, 10);
+    BOOST_REQUIRE(db.create());
+
+    db.push(block0, 0, 0);
+
+    hash_list branch;
+    BOOST_REQUIRE(!db.merkle_branch(branch, block0.hash(), 3));
+
+    for (size_t position = 0; position < 3; ++position)
+    {
+        BOOST_REQUIRE(db.merkle_branch(branch, block0.hash(), position));
+        BOOST_REQUIRE_EQUAL(branch.size(), 2u);
+
+        auto index = position;
+        auto root = block0.transactions()[position].hash();
+
+        for (const auto& sibling: branch)
+        {
+            root = (index % 2 == 0) ?
+                bitcoin_hash(build_chunk({ root, sibling })) :
+                bitcoin_hash(build_chunk({ sibling, root }));
+            index /= 2;
+        }
+
+        BOOST_REQUIRE(root == block0.generate_merkle_root());
+    }
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__work__pushed_headers__cumulative)
+{
+    const auto header0 = block::genesis_mainnet().header();
+    auto header1 = header0;
+    header1.set_previous_block_hash(header0.hash());
+    auto header2 = header0;
+    header2.set_previous_block_hash(header1.hash());
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.create());
+
+    uint256_t work;
+    BOOST_REQUIRE(!db.work(work, header0.hash()));
+
+    db.push(header0, 0);
+    db.push(header1, 1);
+    db.push(header2, 2);
+
+    const auto proof = header0.proof();
+    BOOST_REQUIRE(db.work(work, header0.hash()));
+    BOOST_REQUIRE(work == proof);
+    BOOST_REQUIRE(db.work(work, header2.hash()));
+    BOOST_REQUIRE(work == 3 * proof);
+    BOOST_REQUIRE(db.get(1, false).work() == 2 * proof);
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__pent_heights__pushed_headers__unpopulated_above)
+{
+    const auto header0 = block::genesis_mainnet().header();
+    auto header1 = header0;
+    header1.set_previous_block_hash(header0.hash());
+    auto header2 = header0;
+    header2.set_previous_block_hash(header1.hash());
+    auto header3 = header0;
+    header3.set_previous_block_hash(header2.hash());
+    auto block1 = block::genesis_mainnet();
+    block1.set_header(header1);
+    block1.set_transactions({ random_tx(0), random_tx(1) });
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.create());
+
+    std::vector<size_t> heights;
+    db.pent_heights(heights, 0, 10);
+    BOOST_REQUIRE(heights.empty());
+
+    db.push(header0, 0);
+    db.push(header1, 1);
+    db.push(header2, 2);
+    db.push(header3, 3);
+
+    db.pent_heights(heights, 0, 10);
+    BOOST_REQUIRE_EQUAL(heights.size(), 3u);
+    BOOST_REQUIRE_EQUAL(heights[0], 1u);
+    BOOST_REQUIRE_EQUAL(heights[2], 3u);
+
+    db.pent_heights(heights, 0, 2);
+    BOOST_REQUIRE_EQUAL(heights.size(), 2u);
+    BOOST_REQUIRE_EQUAL(heights[1], 2u);
+
+    // Populated blocks are no longer scheduled.
+    BOOST_REQUIRE(db.update(block1));
+    db.pent_heights(heights, 0, 10);
+    BOOST_REQUIRE_EQUAL(heights.size(), 2u);
+    BOOST_REQUIRE_EQUAL(heights[0], 2u);
+
+    // Popped headers are no longer scheduled.
+    BOOST_REQUIRE(db.unconfirm(header3.hash(), 3, false));
+    db.pent_heights(heights, 0, 10);
+    BOOST_REQUIRE_EQUAL(heights.size(), 1u);
+    BOOST_REQUIRE_EQUAL(heights[0], 2u);
+
+    db.pent_heights(heights, 2, 10);
+    BOOST_REQUIRE(heights.empty());
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(block_database__open__committed_points__restored)
+{
+    const auto header0 = block::genesis_mainnet().header();
+    auto header1 = header0;
+    header1.set_previous_block_hash(header0.hash());
+
+    {
+        block_database_accessor db;
+        BOOST_REQUIRE(db.create());
+        BOOST_REQUIRE_EQUAL(db.fork_point(), 0u);
+        BOOST_REQUIRE_EQUAL(db.valid_point(), 0u);
+
+        db.push(header0, 0);
+        db.push(header1, 1);
+        BOOST_REQUIRE(db.validate(header0.hash(), true));
+        BOOST_REQUIRE(db.validate(header1.hash(), true));
+        BOOST_REQUIRE(db.confirm(header0.hash(), 0, true));
+        BOOST_REQUIRE_EQUAL(db.fork_point(), 1u);
+        BOOST_REQUIRE_EQUAL(db.valid_point(), 1u);
+
+        db.commit();
+        BOOST_REQUIRE(db.close());
+    }
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.open());
+    BOOST_REQUIRE_EQUAL(db.fork_point(), 1u);
+    BOOST_REQUIRE_EQUAL(db.valid_point(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(block_database__get_range__pushed_headers__truncated_at_top)
+{
+    const auto header0 = block::genesis_mainnet().header();
+    auto header1 = header0;
+    header1.set_previous_block_hash(header0.hash());
+    auto header2 = header0;
+    header2.set_previous_block_hash(header1.hash());
+
+    block_database_accessor db;
+    BOOST_REQUIRE(db.create());
+
+    db.push(header0, 0);
+    db.push(header1, 1);
+    db.push(header2, 2);
+
+    const auto results = db.get_range(1, 10, false);
+    BOOST_REQUIRE_EQUAL(results.size(), 2u);
+    BOOST_REQUIRE(results[0]);
+    BOOST_REQUIRE(results[0].header() == header1);
+    BOOST_REQUIRE_EQUAL(results[0].height(), 1u);
+    BOOST_REQUIRE(results[1].hash() == header2.hash());
+    BOOST_REQUIRE_EQUAL(results[1].height(), 2u);
+    BOOST_REQUIRE(is_indexed(results[1].state()));
+
+    BOOST_REQUIRE_EQUAL(db.get_range(0, 2, false).size(), 2u);
+    BOOST_REQUIRE(db.get_range(3, 10, false).empty());
+    BOOST_REQUIRE(db.get_range(0, 10, true).empty());
+
+    db.commit();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
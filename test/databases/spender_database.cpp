@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace boost::system;
+using namespace boost::filesystem;
+using namespace bc;
+using namespace bc::database;
+
+#define DIRECTORY "spender_database"
+
+struct spender_database_directory_setup_fixture
+{
+    spender_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(database_tests, spender_database_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(spender_database__store_unlink__points__expected)
+{
+    const spender_database::point outpoint1{ 42, 0 };
+    const spender_database::point outpoint2{ 42, 1 };
+    const spender_database::point inpoint1{ 4200, 7 };
+    const spender_database::point inpoint2{ 4300, 0 };
+
+    test::create(DIRECTORY "/spend_table");
+    spender_database db(DIRECTORY "/spend_table", 1000, 50);
+    BOOST_REQUIRE(db.create());
+
+    spender_database::point out_inpoint;
+    BOOST_REQUIRE(!db.get(out_inpoint, outpoint1));
+
+    db.store(outpoint1, inpoint1);
+    db.store(outpoint2, inpoint2);
+
+    BOOST_REQUIRE(db.get(out_inpoint, outpoint1));
+    BOOST_REQUIRE(out_inpoint == inpoint1);
+    BOOST_REQUIRE(db.get(out_inpoint, outpoint2));
+    BOOST_REQUIRE(out_inpoint == inpoint2);
+
+    BOOST_REQUIRE(db.unlink(outpoint1));
+    BOOST_REQUIRE(!db.unlink(outpoint1));
+    BOOST_REQUIRE(!db.get(out_inpoint, outpoint1));
+    BOOST_REQUIRE(db.get(out_inpoint, outpoint2));
+    BOOST_REQUIRE(out_inpoint == inpoint2);
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -55,8 +55,10 @@ BOOST_AUTO_TEST_CASE(transaction_database__test)
     BOOST_REQUIRE(tx2.from_data(wire_tx2));
 
     const auto path = DIRECTORY "/tx_table";
+    const auto witness_path = DIRECTORY "/tx_witness";
     test::create(path);
-    transaction_database db(path, 1000, 50, 0);
+    test::create(witness_path);
+    transaction_database db(path, witness_path, 1000, 50, 0);
     BOOST_REQUIRE(db.create());
 
     const auto hash1 = tx1.hash();
@@ -84,4 +86,85 @@ BOOST_AUTO_TEST_CASE(transaction_database__test)
     db.commit();
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__store__segregated__witness_read_on_request)
+{
+    transaction tx;
+    data_chunk wire_tx;
+    BOOST_REQUIRE(decode_base16(wire_tx, TRANSACTION1));
+    BOOST_REQUIRE(tx.from_data(wire_tx));
+
+    const data_stack stack{ { 0x01, 0x02, 0x03 }, { 0x42 } };
+    tx.inputs()[0].set_witness(witness(stack));
+    BOOST_REQUIRE(tx.is_segregated());
+
+    const auto path = DIRECTORY "/tx_table";
+    const auto witness_path = DIRECTORY "/tx_witness";
+    test::create(path);
+    test::create(witness_path);
+    transaction_database db(path, witness_path, 1000, 50, 0);
+    BOOST_REQUIRE(db.create());
+
+    db.store(tx, 42, 0, 1);
+
+    const auto result = db.get(tx.hash());
+    BOOST_REQUIRE(result);
+
+    const auto stripped = result.transaction(false);
+    BOOST_REQUIRE(stripped.hash() == tx.hash());
+    BOOST_REQUIRE(!stripped.is_segregated());
+
+    const auto witnessed = result.transaction(true);
+    BOOST_REQUIRE(witnessed.hash() == tx.hash());
+    BOOST_REQUIRE(witnessed.is_segregated());
+    BOOST_REQUIRE(witnessed.inputs()[0].witness() == tx.inputs()[0].witness());
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__confirm__spend_segregated__spent)
+{
+    transaction tx;
+    data_chunk wire_tx;
+    BOOST_REQUIRE(decode_base16(wire_tx, TRANSACTION1));
+    BOOST_REQUIRE(tx.from_data(wire_tx));
+
+    const data_stack stack{ { 0x01, 0x02, 0x03 }, { 0x42 } };
+    tx.inputs()[0].set_witness(witness(stack));
+    BOOST_REQUIRE(tx.is_segregated());
+
+    transaction spender;
+    data_chunk wire_spender;
+    BOOST_REQUIRE(decode_base16(wire_spender, TRANSACTION2));
+    BOOST_REQUIRE(spender.from_data(wire_spender));
+    spender.inputs()[0].set_previous_output({ tx.hash(), 0 });
+
+    const auto path = DIRECTORY "/tx_table";
+    const auto witness_path = DIRECTORY "/tx_witness";
+    test::create(path);
+    test::create(witness_path);
+    transaction_database db(path, witness_path, 1000, 50, 0);
+    BOOST_REQUIRE(db.create());
+
+    BOOST_REQUIRE(db.store(tx, 42, 0, 1));
+    BOOST_REQUIRE(db.pool(spender, 0));
+
+    const auto link = db.get(tx.hash()).link();
+    const auto spender_link = db.get(spender.hash()).link();
+
+    // The witnessed tx has one output.
+    BOOST_REQUIRE(!db.unspend(link, 1));
+
+    BOOST_REQUIRE(db.confirm(spender_link, 43, 0, 1));
+
+    const output_point point{ tx.hash(), 0 };
+    BOOST_REQUIRE(db.get_output(point));
+    BOOST_REQUIRE(point.metadata.spent);
+
+    BOOST_REQUIRE(db.unspend(link, 0));
+    BOOST_REQUIRE(db.get_output(point));
+    BOOST_REQUIRE(!point.metadata.spent);
+
+    db.commit();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
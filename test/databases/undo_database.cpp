@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace boost::system;
+using namespace boost::filesystem;
+using namespace bc;
+using namespace bc::database;
+
+#define DIRECTORY "undo_database"
+
+struct undo_database_directory_setup_fixture
+{
+    undo_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(database_tests, undo_database_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(undo_database__store_pop__gapped_heights__expected)
+{
+    const short_hash key1 = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const short_hash key2 = base16_literal("9c6b3bdaa612ceab88d49d4431ed58f26e69b90d");
+    const undo_database::spend_list spends{ { 42, 0 }, { 4200, 7 } };
+    const short_hash_list rows{ key1, key2, key1 };
+
+    test::create(DIRECTORY "/undo_index");
+    test::create(DIRECTORY "/undo_table");
+    undo_database db(DIRECTORY "/undo_index", DIRECTORY "/undo_table", 50);
+    BOOST_REQUIRE(db.create());
+
+    undo_database::spend_list out_spends;
+    short_hash_list out_rows;
+    BOOST_REQUIRE(!db.get(out_spends, out_rows, 0));
+
+    BOOST_REQUIRE(db.store({}, {}, 0));
+    BOOST_REQUIRE(db.store(spends, rows, 3));
+    BOOST_REQUIRE(!db.store(spends, rows, 3));
+
+    BOOST_REQUIRE(db.get(out_spends, out_rows, 0));
+    BOOST_REQUIRE(out_spends.empty());
+    BOOST_REQUIRE(out_rows.empty());
+    BOOST_REQUIRE(!db.get(out_spends, out_rows, 1));
+    BOOST_REQUIRE(!db.get(out_spends, out_rows, 2));
+
+    BOOST_REQUIRE(db.get(out_spends, out_rows, 3));
+    BOOST_REQUIRE(out_spends == spends);
+    BOOST_REQUIRE(out_rows == rows);
+
+    BOOST_REQUIRE(!db.pop(2));
+    BOOST_REQUIRE(db.pop(3));
+    BOOST_REQUIRE(!db.get(out_spends, out_rows, 3));
+    BOOST_REQUIRE(!db.get(out_spends, out_rows, 2));
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(undo_database__pop__skipped_top__restorable)
+{
+    const undo_database::spend_list spends{ { 42, 0 } };
+
+    test::create(DIRECTORY "/undo_index");
+    test::create(DIRECTORY "/undo_table");
+    undo_database db(DIRECTORY "/undo_index", DIRECTORY "/undo_table", 50);
+    BOOST_REQUIRE(db.create());
+
+    // Heights 0 through 2 were confirmed without a journal.
+    BOOST_REQUIRE(db.pop(2));
+
+    // Reorganize across the first journaled height.
+    BOOST_REQUIRE(db.store(spends, 3));
+    BOOST_REQUIRE(db.pop(3));
+    BOOST_REQUIRE(db.pop(2));
+    BOOST_REQUIRE(db.store(spends, 2));
+
+    undo_database::spend_list out_spends;
+    short_hash_list out_rows;
+    BOOST_REQUIRE(db.get(out_spends, out_rows, 2));
+    BOOST_REQUIRE(out_spends == spends);
+    BOOST_REQUIRE(!db.get(out_spends, out_rows, 1));
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_CASE(undo_database__has_rows__with_and_without_rows__expected)
+{
+    const short_hash key1 = base16_literal("a006500b7ddfd568e2b036c65a4f4d6aaa0cbd9b");
+    const undo_database::spend_list spends{ { 42, 0 } };
+
+    test::create(DIRECTORY "/undo_index");
+    test::create(DIRECTORY "/undo_table");
+    undo_database db(DIRECTORY "/undo_index", DIRECTORY "/undo_table", 50);
+    BOOST_REQUIRE(db.create());
+
+    BOOST_REQUIRE(db.store(spends, {}, 0));
+    BOOST_REQUIRE(db.store(spends, 1));
+    BOOST_REQUIRE(db.store(spends, { key1 }, 2));
+
+    BOOST_REQUIRE(db.has_rows(0));
+    BOOST_REQUIRE(!db.has_rows(1));
+    BOOST_REQUIRE(db.has_rows(2));
+    BOOST_REQUIRE(!db.has_rows(3));
+
+    undo_database::spend_list out_spends;
+    short_hash_list out_rows;
+    BOOST_REQUIRE(db.get(out_spends, out_rows, 1));
+    BOOST_REQUIRE(out_spends == spends);
+    BOOST_REQUIRE(out_rows.empty());
+
+    db.commit();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(header_cache_tests)
+
+static const hash_digest key0 = hash_literal("0000000000000000000000000000000000000000000000000000000000000042");
+static const hash_digest key1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000043");
+
+BOOST_AUTO_TEST_CASE(header_cache__construct__always__empty)
+{
+    const header_cache cache(4);
+    BOOST_REQUIRE(cache.empty());
+    BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__push__two__size_2)
+{
+    header_cache cache(4);
+    cache.push(7, key0, 0, { 1, 2, 3, 4 });
+    cache.push(9, key1, 1, { 5, 6, 7, 8 });
+    BOOST_REQUIRE(!cache.empty());
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__pop__top__truncated)
+{
+    header_cache cache(4);
+    cache.push(7, key0, 0, { 1, 2, 3, 4 });
+    cache.push(9, key1, 1, { 5, 6, 7, 8 });
+    cache.pop(1);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+
+    array_index link;
+    BOOST_REQUIRE(!cache.link(link, 1));
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__clear__populated__empty)
+{
+    header_cache cache(4);
+    cache.push(7, key0, 0, { 1, 2, 3, 4 });
+    cache.clear();
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__link__pushed__expected)
+{
+    header_cache cache(4);
+    cache.push(7, key0, 0, { 1, 2, 3, 4 });
+    cache.push(9, key1, 1, { 5, 6, 7, 8 });
+
+    array_index link;
+    BOOST_REQUIRE(cache.link(link, 0));
+    BOOST_REQUIRE_EQUAL(link, 7u);
+    BOOST_REQUIRE(cache.link(link, 1));
+    BOOST_REQUIRE_EQUAL(link, 9u);
+    BOOST_REQUIRE(!cache.link(link, 2));
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__read__matching_link__expected)
+{
+    header_cache cache(4);
+    cache.push(7, key0, 0, { 1, 2, 3, 4 });
+    cache.push(9, key1, 1, { 5, 6, 7, 8 });
+
+    data_chunk value;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        value = deserial.read_bytes(4);
+    };
+
+    hash_digest key;
+    BOOST_REQUIRE(cache.read(key, 9, 1, reader));
+    BOOST_REQUIRE(key == key1);
+    BOOST_REQUIRE((value == data_chunk{ 5, 6, 7, 8 }));
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__read__mismatched_link__false)
+{
+    header_cache cache(4);
+    cache.push(7, key0, 0, { 1, 2, 3, 4 });
+
+    auto called = false;
+    const auto reader = [&](byte_deserializer&)
+    {
+        called = true;
+    };
+
+    hash_digest key;
+    BOOST_REQUIRE(!cache.read(key, 8, 0, reader));
+    BOOST_REQUIRE(!cache.read(key, 7, 1, reader));
+    BOOST_REQUIRE(!called);
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__write__matching_link__updated)
+{
+    header_cache cache(4);
+    cache.push(7, key0, 0, { 1, 2, 3, 4 });
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.skip(2);
+        serial.write_byte(42);
+    };
+
+    BOOST_REQUIRE(cache.write(7, 0, writer));
+    BOOST_REQUIRE(!cache.write(8, 0, writer));
+
+    data_chunk value;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        value = deserial.read_bytes(4);
+    };
+
+    hash_digest key;
+    BOOST_REQUIRE(cache.read(key, 7, 0, reader));
+    BOOST_REQUIRE((value == data_chunk{ 1, 2, 42, 4 }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
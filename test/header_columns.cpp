@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(header_columns_tests)
+
+static header make_header(uint32_t version, uint32_t timestamp, uint32_t bits)
+{
+    return { version, null_hash, null_hash, timestamp, bits, 0 };
+}
+
+BOOST_AUTO_TEST_CASE(header_columns__construct__always__empty)
+{
+    const header_columns columns;
+    BOOST_REQUIRE_EQUAL(columns.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_columns__push__two__expected_columns)
+{
+    header_columns columns;
+    columns.push(make_header(1, 10, 100), 0);
+    columns.push(make_header(2, 20, 200), 1);
+    BOOST_REQUIRE_EQUAL(columns.size(), 2u);
+
+    header_columns::column out;
+    BOOST_REQUIRE(columns.versions(out, 0, 2));
+    BOOST_REQUIRE((out == header_columns::column{ 1, 2 }));
+    BOOST_REQUIRE(columns.timestamps(out, 0, 2));
+    BOOST_REQUIRE((out == header_columns::column{ 10, 20 }));
+    BOOST_REQUIRE(columns.bits(out, 1, 1));
+    BOOST_REQUIRE((out == header_columns::column{ 200 }));
+    BOOST_REQUIRE(columns.median_time_pasts(out, 0, 2));
+    BOOST_REQUIRE((out == header_columns::column{ 0, 10 }));
+}
+
+BOOST_AUTO_TEST_CASE(header_columns__push__fourteen__median_of_previous_11)
+{
+    header_columns columns;
+
+    // Timestamps are out of order so that the median requires sorting.
+    for (uint32_t height = 0; height < 14; ++height)
+        columns.push(make_header(1, 1000 + (height * 7) % 13 * 10, 100),
+            height);
+
+    header_columns::column out;
+    BOOST_REQUIRE(columns.median_time_pasts(out, 10, 4));
+    BOOST_REQUIRE((out == header_columns::column{ 1070, 1050, 1070, 1060 }));
+}
+
+BOOST_AUTO_TEST_CASE(header_columns__timestamps__out_of_range__false)
+{
+    header_columns columns;
+    columns.push(make_header(1, 10, 100), 0);
+
+    header_columns::column out;
+    BOOST_REQUIRE(!columns.timestamps(out, 0, 2));
+    BOOST_REQUIRE(!columns.timestamps(out, 2, 0));
+    BOOST_REQUIRE(columns.timestamps(out, 1, 0));
+    BOOST_REQUIRE(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(header_columns__pop__top__truncated)
+{
+    header_columns columns;
+    columns.push(make_header(1, 10, 100), 0);
+    columns.push(make_header(2, 20, 200), 1);
+    columns.pop(1);
+    BOOST_REQUIRE_EQUAL(columns.size(), 1u);
+
+    header_columns::column out;
+    BOOST_REQUIRE(!columns.bits(out, 1, 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,288 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace bc;
+using namespace bc::database;
+
+// Test directory
+#define DIRECTORY "write_log"
+
+struct write_log_directory_setup_fixture
+{
+    write_log_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+        log::initialize();
+    }
+};
+
+struct logged_write
+{
+    size_t file;
+    file_offset offset;
+    data_chunk data;
+};
+
+typedef std::vector<logged_write> logged_writes;
+
+static write_log::replay_handler collect(logged_writes& writes)
+{
+    return [&](size_t file, file_offset offset, const data_chunk& data)
+    {
+        writes.push_back({ file, offset, data });
+        return true;
+    };
+}
+
+static const auto succeed = []() { return true; };
+
+BOOST_FIXTURE_TEST_SUITE(write_log_tests, write_log_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(write_log__open__missing__created_empty)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    write_log instance(file, { "a", "b" });
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(test::exists(file));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(write_log__open__opened__failure)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(!instance.open());
+}
+
+BOOST_AUTO_TEST_CASE(write_log__end__no_writes__empty)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.begin(succeed));
+    BOOST_REQUIRE(instance.end(succeed, succeed));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(write_log__end__nested_sequence__deferred)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const data_chunk data{ 0x01, 0x02, 0x03 };
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.begin(succeed));
+    BOOST_REQUIRE(instance.begin(succeed));
+    instance.write(0, 42, data.data(), data.size());
+    BOOST_REQUIRE(instance.end(succeed, succeed));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(instance.end(succeed, succeed));
+    BOOST_REQUIRE_EQUAL(instance.size(), 8u + 1u + 8u + 2u + data.size());
+}
+
+BOOST_AUTO_TEST_CASE(write_log__begin__overlapping_sequences__handlers_once)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+
+    size_t starts = 0;
+    size_t stops = 0;
+    const auto start = [&]() { ++starts; return true; };
+    const auto stop = [&]() { ++stops; return true; };
+
+    BOOST_REQUIRE(instance.begin(start));
+    BOOST_REQUIRE(instance.begin(start));
+    BOOST_REQUIRE_EQUAL(starts, 1u);
+    BOOST_REQUIRE(instance.end(succeed, stop));
+    BOOST_REQUIRE_EQUAL(stops, 0u);
+    BOOST_REQUIRE(instance.begin(start));
+    BOOST_REQUIRE(instance.end(succeed, stop));
+    BOOST_REQUIRE(instance.end(succeed, stop));
+    BOOST_REQUIRE_EQUAL(starts, 1u);
+    BOOST_REQUIRE_EQUAL(stops, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(write_log__begin__start_failure__not_started)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+
+    size_t stops = 0;
+    const auto fail = []() { return false; };
+    const auto stop = [&]() { ++stops; return true; };
+
+    BOOST_REQUIRE(!instance.begin(fail));
+
+    // The failed sequence is not counted, so this is the last to end.
+    BOOST_REQUIRE(instance.begin(succeed));
+    BOOST_REQUIRE(instance.end(succeed, stop));
+    BOOST_REQUIRE_EQUAL(stops, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(write_log__replay__reopened__expected_writes_in_order)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const data_chunk data1{ 0x01, 0x02, 0x03 };
+    static const data_chunk data2{ 0x04 };
+    static const data_chunk data3{ 0x05, 0x06 };
+
+    {
+        write_log instance(file, { "a", "b" });
+        BOOST_REQUIRE(instance.open());
+        BOOST_REQUIRE(instance.begin(succeed));
+        instance.write(0, 42, data1.data(), data1.size());
+        instance.write(1, 7, data2.data(), data2.size());
+        BOOST_REQUIRE(instance.end(succeed, succeed));
+        BOOST_REQUIRE(instance.begin(succeed));
+        instance.write(0, 42, data3.data(), data3.size());
+        BOOST_REQUIRE(instance.end(succeed, succeed));
+        BOOST_REQUIRE(instance.close());
+    }
+
+    write_log instance(file, { "a", "b" });
+    BOOST_REQUIRE(instance.open());
+
+    logged_writes writes;
+    BOOST_REQUIRE(instance.replay(collect(writes)));
+    BOOST_REQUIRE_EQUAL(writes.size(), 3u);
+    BOOST_REQUIRE_EQUAL(writes[0].file, 0u);
+    BOOST_REQUIRE_EQUAL(writes[0].offset, 42u);
+    BOOST_REQUIRE(writes[0].data == data1);
+    BOOST_REQUIRE_EQUAL(writes[1].file, 1u);
+    BOOST_REQUIRE_EQUAL(writes[1].offset, 7u);
+    BOOST_REQUIRE(writes[1].data == data2);
+    BOOST_REQUIRE_EQUAL(writes[2].file, 0u);
+    BOOST_REQUIRE_EQUAL(writes[2].offset, 42u);
+    BOOST_REQUIRE(writes[2].data == data3);
+}
+
+BOOST_AUTO_TEST_CASE(write_log__replay__torn_batch__ignored)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const data_chunk data{ 0x01, 0x02, 0x03 };
+
+    {
+        write_log instance(file, { "a" });
+        BOOST_REQUIRE(instance.open());
+        BOOST_REQUIRE(instance.begin(succeed));
+        instance.write(0, 1, data.data(), data.size());
+        BOOST_REQUIRE(instance.end(succeed, succeed));
+        BOOST_REQUIRE(instance.begin(succeed));
+        instance.write(0, 2, data.data(), data.size());
+        BOOST_REQUIRE(instance.end(succeed, succeed));
+        BOOST_REQUIRE(instance.close());
+    }
+
+    // Tear the last byte of the second batch.
+    boost::filesystem::resize_file(file, boost::filesystem::file_size(file) -
+        1u);
+
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+
+    logged_writes writes;
+    BOOST_REQUIRE(instance.replay(collect(writes)));
+    BOOST_REQUIRE_EQUAL(writes.size(), 1u);
+    BOOST_REQUIRE_EQUAL(writes[0].offset, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(write_log__replay__handler_failure__false)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const data_chunk data{ 0x01 };
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.begin(succeed));
+    instance.write(0, 1, data.data(), data.size());
+    BOOST_REQUIRE(instance.end(succeed, succeed));
+
+    const auto fail = [](size_t, file_offset, const data_chunk&)
+    {
+        return false;
+    };
+
+    BOOST_REQUIRE(!instance.replay(fail));
+}
+
+BOOST_AUTO_TEST_CASE(write_log__reset__logged__empty)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const data_chunk data{ 0x01 };
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.begin(succeed));
+    instance.write(0, 1, data.data(), data.size());
+    BOOST_REQUIRE(instance.end(succeed, succeed));
+    BOOST_REQUIRE(instance.size() != 0u);
+    BOOST_REQUIRE(instance.reset());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+
+    logged_writes writes;
+    BOOST_REQUIRE(instance.replay(collect(writes)));
+    BOOST_REQUIRE(writes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(write_log__attach__unlogged_file__false)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string logged = DIRECTORY "/" + TEST_NAME + "_file";
+    BOOST_REQUIRE(test::create(logged));
+    file_storage storage(logged);
+    write_log instance(file, { "a" });
+    BOOST_REQUIRE(!instance.attach(storage));
+}
+
+BOOST_AUTO_TEST_CASE(write_log__end__attached_file_write__logged)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string logged = DIRECTORY "/" + TEST_NAME + "_file";
+    BOOST_REQUIRE(test::create(logged));
+    file_storage storage(logged);
+    BOOST_REQUIRE(storage.open());
+
+    write_log instance(file, { "a", logged });
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.attach(storage));
+
+    BOOST_REQUIRE(instance.begin(succeed));
+    {
+        const auto memory = storage.reserve(10);
+        const auto buffer = memory->buffer();
+        buffer[5] = 0x2a;
+        storage.log_write(buffer + 5, 1);
+    }
+    BOOST_REQUIRE(instance.end(succeed, succeed));
+
+    logged_writes writes;
+    BOOST_REQUIRE(instance.replay(collect(writes)));
+    BOOST_REQUIRE_EQUAL(writes.size(), 1u);
+    BOOST_REQUIRE_EQUAL(writes[0].file, 1u);
+    BOOST_REQUIRE_EQUAL(writes[0].offset, 5u);
+    BOOST_REQUIRE(writes[0].data == data_chunk{ 0x2a });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(merkle_cache_tests)
+
+static const hash_digest hash0 = hash_literal("0000000000000000000000000000000000000000000000000000000000000042");
+static const hash_digest hash1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000043");
+static const hash_digest hash2 = hash_literal("0000000000000000000000000000000000000000000000000000000000000044");
+
+BOOST_AUTO_TEST_CASE(merkle_cache__build__one__root_is_leaf)
+{
+    const auto tree = merkle_cache::build({ hash0 });
+    BOOST_REQUIRE_EQUAL(tree->size(), 1u);
+    BOOST_REQUIRE(tree->back().front() == hash0);
+    BOOST_REQUIRE(merkle_cache::branch(*tree, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__build__three__odd_level_paired_with_self)
+{
+    const auto tree = merkle_cache::build({ hash0, hash1, hash2 });
+    BOOST_REQUIRE_EQUAL(tree->size(), 3u);
+
+    const auto left = bitcoin_hash(build_chunk({ hash0, hash1 }));
+    const auto right = bitcoin_hash(build_chunk({ hash2, hash2 }));
+    BOOST_REQUIRE((*tree)[1][0] == left);
+    BOOST_REQUIRE((*tree)[1][1] == right);
+    BOOST_REQUIRE((*tree)[2][0] == bitcoin_hash(build_chunk({ left, right })));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__branch__position_out_of_range__empty)
+{
+    const auto tree = merkle_cache::build({ hash0, hash1, hash2 });
+    BOOST_REQUIRE(merkle_cache::branch(*tree, 3).empty());
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__branch__last_position__self_sibling)
+{
+    const auto tree = merkle_cache::build({ hash0, hash1, hash2 });
+    const auto branch = merkle_cache::branch(*tree, 2);
+    BOOST_REQUIRE_EQUAL(branch.size(), 2u);
+    BOOST_REQUIRE(branch[0] == hash2);
+    BOOST_REQUIRE(branch[1] == bitcoin_hash(build_chunk({ hash0, hash1 })));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__add__capacity_0__disabled)
+{
+    merkle_cache cache(0);
+    cache.add(hash0, merkle_cache::build({ hash0 }));
+    BOOST_REQUIRE(cache.disabled());
+    BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+    BOOST_REQUIRE(!cache.find(hash0));
+}
+
+BOOST_AUTO_TEST_CASE(merkle_cache__add__over_capacity__least_recently_used_removed)
+{
+    merkle_cache cache(2);
+    const auto tree = merkle_cache::build({ hash0 });
+    cache.add(hash0, tree);
+    cache.add(hash1, tree);
+
+    // Use hash0 so that hash1 is the least recently used.
+    BOOST_REQUIRE(cache.find(hash0));
+    cache.add(hash2, tree);
+
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+    BOOST_REQUIRE(cache.find(hash0));
+    BOOST_REQUIRE(!cache.find(hash1));
+    BOOST_REQUIRE(cache.find(hash2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -87,6 +87,28 @@ BOOST_AUTO_TEST_CASE(record_manager__allocate__two_records__expected)
     BOOST_REQUIRE_GE(file.size(), link_size + 2 * record_size);
 }
 
+BOOST_AUTO_TEST_CASE(record_manager__reserve__two_records__not_counted_until_allocated)
+{
+    typedef uint32_t link_type;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+
+    const auto record_size = 10u;
+    const auto link_size = sizeof(link_type);
+    record_manager<link_type> manager(file, 0, record_size);
+    BOOST_REQUIRE(manager.create());
+    BOOST_REQUIRE_EQUAL(manager.allocate(1), 0u);
+
+    const auto link = manager.reserve(2);
+    BOOST_REQUIRE_EQUAL(link, 1u);
+    BOOST_REQUIRE_EQUAL(manager.count(), 1u);
+    BOOST_REQUIRE_GE(file.size(), link_size + 3 * record_size);
+
+    BOOST_REQUIRE_EQUAL(manager.allocate(2), link);
+    BOOST_REQUIRE_EQUAL(manager.count(), 3u);
+}
+
 BOOST_AUTO_TEST_CASE(record_manager__count__multiple_records_with_offset__expected)
 {
     typedef uint64_t link_type;
@@ -32,12 +32,20 @@ BOOST_AUTO_TEST_CASE(settings__construct__default_context__expected)
     database::settings configuration;
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(configuration.index_addresses);
+    BOOST_REQUIRE_EQUAL(configuration.address_index_threads, 0u);
+    BOOST_REQUIRE(!configuration.defer_address_index);
+    BOOST_REQUIRE(!configuration.index_script_hashes);
+    BOOST_REQUIRE(!configuration.index_spends);
+    BOOST_REQUIRE(!configuration.cache_headers);
     BOOST_REQUIRE(!configuration.flush_writes);
+    BOOST_REQUIRE(!configuration.log_writes);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.spend_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.cache_capacity, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.merkle_cache_capacity, 0u);
 }
 
 BOOST_AUTO_TEST_CASE(settings__construct__none_context__expected)
@@ -45,12 +53,20 @@ BOOST_AUTO_TEST_CASE(settings__construct__none_context__expected)
     database::settings configuration(config::settings::none);
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(configuration.index_addresses);
+    BOOST_REQUIRE_EQUAL(configuration.address_index_threads, 0u);
+    BOOST_REQUIRE(!configuration.defer_address_index);
+    BOOST_REQUIRE(!configuration.index_script_hashes);
+    BOOST_REQUIRE(!configuration.index_spends);
+    BOOST_REQUIRE(!configuration.cache_headers);
     BOOST_REQUIRE(!configuration.flush_writes);
+    BOOST_REQUIRE(!configuration.log_writes);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.spend_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.cache_capacity, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.merkle_cache_capacity, 0u);
 }
 
 BOOST_AUTO_TEST_CASE(settings__construct__mainnet_context__expected)
@@ -58,12 +74,20 @@ BOOST_AUTO_TEST_CASE(settings__construct__mainnet_context__expected)
     database::settings configuration(config::settings::mainnet);
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(configuration.index_addresses);
+    BOOST_REQUIRE_EQUAL(configuration.address_index_threads, 0u);
+    BOOST_REQUIRE(!configuration.defer_address_index);
+    BOOST_REQUIRE(!configuration.index_script_hashes);
+    BOOST_REQUIRE(!configuration.index_spends);
+    BOOST_REQUIRE(!configuration.cache_headers);
     BOOST_REQUIRE(!configuration.flush_writes);
+    BOOST_REQUIRE(!configuration.log_writes);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 650000u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 110000000u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 107000000u);
+    BOOST_REQUIRE_EQUAL(configuration.spend_table_buckets, 250000000u);
     BOOST_REQUIRE_EQUAL(configuration.cache_capacity, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.merkle_cache_capacity, 0u);
 }
 
 BOOST_AUTO_TEST_CASE(settings__construct__testnet_context__expected)
@@ -71,12 +95,20 @@ BOOST_AUTO_TEST_CASE(settings__construct__testnet_context__expected)
     database::settings configuration(config::settings::testnet);
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(configuration.index_addresses);
+    BOOST_REQUIRE_EQUAL(configuration.address_index_threads, 0u);
+    BOOST_REQUIRE(!configuration.defer_address_index);
+    BOOST_REQUIRE(!configuration.index_script_hashes);
+    BOOST_REQUIRE(!configuration.index_spends);
+    BOOST_REQUIRE(!configuration.cache_headers);
     BOOST_REQUIRE(!configuration.flush_writes);
+    BOOST_REQUIRE(!configuration.log_writes);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 650000u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 110000000u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 107000000u);
+    BOOST_REQUIRE_EQUAL(configuration.spend_table_buckets, 250000000u);
     BOOST_REQUIRE_EQUAL(configuration.cache_capacity, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.merkle_cache_capacity, 0u);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(short_id_tests)
+
+// Reference vectors from the SipHash paper (key 00..0f, message 00..).
+static const short_id_key key{ 0x0706050403020100, 0x0f0e0d0c0b0a0908 };
+
+BOOST_AUTO_TEST_CASE(short_id__siphash__empty__expected)
+{
+    BOOST_REQUIRE_EQUAL(siphash(key, nullptr, 0), 0x726fdb47dd0e0e31);
+}
+
+BOOST_AUTO_TEST_CASE(short_id__siphash__15_bytes__expected)
+{
+    const data_chunk data{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+    BOOST_REQUIRE_EQUAL(siphash(key, data.data(), data.size()), 0xa129ca6149be45e5);
+}
+
+BOOST_AUTO_TEST_CASE(short_id__short_id_nonce__block_hash__first_8_bytes)
+{
+    const auto hash = block::genesis_mainnet().hash();
+    BOOST_REQUIRE_EQUAL(short_id_nonce(hash), from_little_endian_unsafe<uint64_t>(hash.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(short_id__to_short_id_key__nonce__first_16_bytes_of_sha256)
+{
+    const auto header = block::genesis_mainnet().header();
+    const auto digest = sha256_hash(build_chunk({ header.to_data(), to_little_endian<uint64_t>(42) }));
+    const auto result = to_short_id_key(header, 42);
+    BOOST_REQUIRE_EQUAL(result.first, from_little_endian_unsafe<uint64_t>(digest.begin()));
+    BOOST_REQUIRE_EQUAL(result.second, from_little_endian_unsafe<uint64_t>(digest.begin() + 8));
+}
+
+BOOST_AUTO_TEST_CASE(short_id__short_id__hash__low_6_bytes_of_siphash)
+{
+    const auto hash = block::genesis_mainnet().hash();
+    const auto value = siphash(key, hash.data(), hash.size());
+    const auto bytes = to_little_endian(value);
+    const auto result = short_id(key, hash);
+    BOOST_REQUIRE(std::equal(result.begin(), result.end(), bytes.begin()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(short_id_map_tests)
+
+static const short_id_key key{ 42, 24 };
+static const hash_digest hash0 = hash_literal("0000000000000000000000000000000000000000000000000000000000000042");
+static const hash_digest hash1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000043");
+
+BOOST_AUTO_TEST_CASE(short_id_map__construct__always__empty)
+{
+    const short_id_map map(key);
+    BOOST_REQUIRE_EQUAL(map.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(short_id_map__add__distinct__found)
+{
+    short_id_map map(key);
+    BOOST_REQUIRE(map.add(hash0, 7));
+    BOOST_REQUIRE(map.add(hash1, 9));
+    BOOST_REQUIRE_EQUAL(map.size(), 2u);
+
+    file_offset link;
+    BOOST_REQUIRE(map.find(link, short_id(key, hash0)));
+    BOOST_REQUIRE_EQUAL(link, 7u);
+    BOOST_REQUIRE(map.find(link, short_id(key, hash1)));
+    BOOST_REQUIRE_EQUAL(link, 9u);
+}
+
+BOOST_AUTO_TEST_CASE(short_id_map__add__same_link_twice__true)
+{
+    short_id_map map(key);
+    BOOST_REQUIRE(map.add(hash0, 7));
+    BOOST_REQUIRE(map.add(hash0, 7));
+    BOOST_REQUIRE_EQUAL(map.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(short_id_map__add__collision__not_found)
+{
+    short_id_map map(key);
+    BOOST_REQUIRE(map.add(hash0, 7));
+    BOOST_REQUIRE(!map.add(hash0, 8));
+
+    file_offset link;
+    BOOST_REQUIRE(!map.find(link, short_id(key, hash0)));
+}
+
+BOOST_AUTO_TEST_CASE(short_id_map__match__partial__expected)
+{
+    short_id_map map(key);
+    BOOST_REQUIRE(map.add(hash0, 7));
+
+    short_id_map::link_list links;
+    const short_id_map::short_id_list ids{ short_id(key, hash1), short_id(key, hash0) };
+    BOOST_REQUIRE_EQUAL(map.match(links, ids), 1u);
+    BOOST_REQUIRE_EQUAL(links.size(), 2u);
+    BOOST_REQUIRE_EQUAL(links[0], short_id_map::not_found);
+    BOOST_REQUIRE_EQUAL(links[1], 7u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
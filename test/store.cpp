@@ -32,8 +32,8 @@ class store_accessor
 {
 public:
     store_accessor(const path& prefix, bool indexes=false, bool flush=false,
-        bool result=true)
-      : store(prefix, indexes, flush), result_(result)
+        bool result=true, bool log=false)
+      : store(prefix, indexes, flush, log), result_(result)
     {
     }
 
@@ -65,6 +65,25 @@ BOOST_AUTO_TEST_CASE(store__construct__flush_each_write_true__expected)
     BOOST_REQUIRE(store.flush_each_write());
 }
 
+BOOST_AUTO_TEST_CASE(store__construct__log_each_write_false__expected)
+{
+    store_accessor store("");
+    BOOST_REQUIRE(!store.log_each_write());
+}
+
+BOOST_AUTO_TEST_CASE(store__construct__log_each_write_true__expected)
+{
+    store_accessor store("", false, false, true, true);
+    BOOST_REQUIRE(store.log_each_write());
+}
+
+BOOST_AUTO_TEST_CASE(store__construct__log_and_flush_each_write__flush_only)
+{
+    store_accessor store("", false, true, true, true);
+    BOOST_REQUIRE(store.flush_each_write());
+    BOOST_REQUIRE(!store.log_each_write());
+}
+
 using namespace boost::filesystem;
 static bool create_file(const path& file_path)
 {
@@ -91,17 +110,31 @@ BOOST_AUTO_TEST_CASE(store__construct__no_indexes__expected_files)
     static const std::string block_index = directory + "/" + store::BLOCK_INDEX;
     static const std::string block_table = directory + "/" + store::BLOCK_TABLE;
     static const std::string tx_index = directory + "/" + store::TRANSACTION_INDEX;
+    static const std::string short_id_index = directory + "/" + store::SHORT_ID_INDEX;
+    static const std::string tx_hash_index = directory + "/" + store::TRANSACTION_HASH_INDEX;
+    static const std::string pent_index = directory + "/" + store::PENT_INDEX;
     static const std::string tx_table = directory + "/" + store::TRANSACTION_TABLE;
+    static const std::string tx_witness = directory + "/" + store::TRANSACTION_WITNESS;
+    static const std::string undo_index = directory + "/" + store::UNDO_INDEX;
+    static const std::string undo_table = directory + "/" + store::UNDO_TABLE;
     static const std::string address_table = directory + "/" + store::ADDRESS_TABLE;
     static const std::string address_rows = directory + "/" + store::ADDRESS_ROWS;
+    static const std::string spend_table = directory + "/" + store::SPEND_TABLE;
 
     BOOST_REQUIRE(!test::exists(header_index));
     BOOST_REQUIRE(!test::exists(block_index));
     BOOST_REQUIRE(!test::exists(block_table));
     BOOST_REQUIRE(!test::exists(tx_index));
+    BOOST_REQUIRE(!test::exists(short_id_index));
+    BOOST_REQUIRE(!test::exists(tx_hash_index));
+    BOOST_REQUIRE(!test::exists(pent_index));
     BOOST_REQUIRE(!test::exists(tx_table));
+    BOOST_REQUIRE(!test::exists(tx_witness));
+    BOOST_REQUIRE(!test::exists(undo_index));
+    BOOST_REQUIRE(!test::exists(undo_table));
     BOOST_REQUIRE(!test::exists(address_table));
     BOOST_REQUIRE(!test::exists(address_rows));
+    BOOST_REQUIRE(!test::exists(spend_table));
 
     BOOST_REQUIRE(store.create());
 
@@ -109,9 +142,16 @@ BOOST_AUTO_TEST_CASE(store__construct__no_indexes__expected_files)
     BOOST_REQUIRE(test::exists(block_index));
     BOOST_REQUIRE(test::exists(block_table));
     BOOST_REQUIRE(test::exists(tx_index));
+    BOOST_REQUIRE(test::exists(short_id_index));
+    BOOST_REQUIRE(test::exists(tx_hash_index));
+    BOOST_REQUIRE(test::exists(pent_index));
     BOOST_REQUIRE(test::exists(tx_table));
+    BOOST_REQUIRE(test::exists(tx_witness));
+    BOOST_REQUIRE(test::exists(undo_index));
+    BOOST_REQUIRE(test::exists(undo_table));
     BOOST_REQUIRE(!test::exists(address_table));
     BOOST_REQUIRE(!test::exists(address_rows));
+    BOOST_REQUIRE(!test::exists(spend_table));
 
     BOOST_REQUIRE(store.close());
 }
@@ -125,17 +165,31 @@ BOOST_AUTO_TEST_CASE(store__construct__indexes__expected_files)
     static const std::string block_index = directory + "/" + store::BLOCK_INDEX;
     static const std::string block_table = directory + "/" + store::BLOCK_TABLE;
     static const std::string tx_index = directory + "/" + store::TRANSACTION_INDEX;
+    static const std::string short_id_index = directory + "/" + store::SHORT_ID_INDEX;
+    static const std::string tx_hash_index = directory + "/" + store::TRANSACTION_HASH_INDEX;
+    static const std::string pent_index = directory + "/" + store::PENT_INDEX;
     static const std::string tx_table = directory + "/" + store::TRANSACTION_TABLE;
+    static const std::string tx_witness = directory + "/" + store::TRANSACTION_WITNESS;
+    static const std::string undo_index = directory + "/" + store::UNDO_INDEX;
+    static const std::string undo_table = directory + "/" + store::UNDO_TABLE;
     static const std::string address_table = directory + "/" + store::ADDRESS_TABLE;
     static const std::string address_rows = directory + "/" + store::ADDRESS_ROWS;
+    static const std::string spend_table = directory + "/" + store::SPEND_TABLE;
 
     BOOST_REQUIRE(!test::exists(header_index));
     BOOST_REQUIRE(!test::exists(block_index));
     BOOST_REQUIRE(!test::exists(block_table));
     BOOST_REQUIRE(!test::exists(tx_index));
+    BOOST_REQUIRE(!test::exists(short_id_index));
+    BOOST_REQUIRE(!test::exists(tx_hash_index));
+    BOOST_REQUIRE(!test::exists(pent_index));
     BOOST_REQUIRE(!test::exists(tx_table));
+    BOOST_REQUIRE(!test::exists(tx_witness));
+    BOOST_REQUIRE(!test::exists(undo_index));
+    BOOST_REQUIRE(!test::exists(undo_table));
     BOOST_REQUIRE(!test::exists(address_table));
     BOOST_REQUIRE(!test::exists(address_rows));
+    BOOST_REQUIRE(!test::exists(spend_table));
 
     BOOST_REQUIRE(store.create());
 
@@ -143,9 +197,16 @@ BOOST_AUTO_TEST_CASE(store__construct__indexes__expected_files)
     BOOST_REQUIRE(test::exists(block_index));
     BOOST_REQUIRE(test::exists(block_table));
     BOOST_REQUIRE(test::exists(tx_index));
+    BOOST_REQUIRE(test::exists(short_id_index));
+    BOOST_REQUIRE(test::exists(tx_hash_index));
+    BOOST_REQUIRE(test::exists(pent_index));
     BOOST_REQUIRE(test::exists(tx_table));
+    BOOST_REQUIRE(test::exists(tx_witness));
+    BOOST_REQUIRE(test::exists(undo_index));
+    BOOST_REQUIRE(test::exists(undo_table));
     BOOST_REQUIRE(test::exists(address_table));
     BOOST_REQUIRE(test::exists(address_rows));
+    BOOST_REQUIRE(test::exists(spend_table));
 
     BOOST_REQUIRE(store.close());
 }
@@ -215,6 +276,50 @@ BOOST_AUTO_TEST_CASE(store__construct__local_flush_lock__expected_files)
     BOOST_REQUIRE(!test::exists(flush_lock));
 }
 
+BOOST_AUTO_TEST_CASE(store__construct__logged_flush_lock__expected_files)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    store_accessor store(directory, false, false, true, true);
+
+    static const std::string flush_lock = directory + "/" + store::FLUSH_LOCK;
+    static const std::string log_file = directory + "/" + store::WRITE_LOG;
+    BOOST_REQUIRE(store.create());
+    BOOST_REQUIRE(!test::exists(log_file));
+    BOOST_REQUIRE(store.open());
+    BOOST_REQUIRE(test::exists(log_file));
+    BOOST_REQUIRE(!test::exists(flush_lock));
+
+    BOOST_REQUIRE(store.begin_write());
+    BOOST_REQUIRE(test::exists(flush_lock));
+    BOOST_REQUIRE(store.end_write());
+    BOOST_REQUIRE(!test::exists(flush_lock));
+
+    BOOST_REQUIRE(store.close());
+    BOOST_REQUIRE(!test::exists(flush_lock));
+}
+
+BOOST_AUTO_TEST_CASE(store__construct__logged_overlapping_writes__lock_until_last_end)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    store_accessor store(directory, false, false, true, true);
+
+    static const std::string flush_lock = directory + "/" + store::FLUSH_LOCK;
+    BOOST_REQUIRE(store.create());
+    BOOST_REQUIRE(store.open());
+    BOOST_REQUIRE(!test::exists(flush_lock));
+
+    BOOST_REQUIRE(store.begin_write());
+    BOOST_REQUIRE(store.begin_write());
+    BOOST_REQUIRE(test::exists(flush_lock));
+    BOOST_REQUIRE(store.end_write());
+    BOOST_REQUIRE(test::exists(flush_lock));
+    BOOST_REQUIRE(store.end_write());
+    BOOST_REQUIRE(!test::exists(flush_lock));
+
+    BOOST_REQUIRE(store.close());
+    BOOST_REQUIRE(!test::exists(flush_lock));
+}
+
 BOOST_AUTO_TEST_CASE(store__construct__unbalanced_begin_write__leaves_lock_after_close)
 {
     static const std::string directory = DIRECTORY "/" + TEST_NAME;
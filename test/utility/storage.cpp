@@ -103,6 +103,15 @@ memory_ptr storage::access()
     return memory;
 }
 
+// Writes are not logged, the buffer is not persistent.
+void storage::log_write(const uint8_t*, size_t)
+{
+}
+
+void storage::log_allocation(size_t)
+{
+}
+
 memory_ptr storage::resize(size_t size)
 {
     return reserve(size);
@@ -125,4 +134,13 @@ memory_ptr storage::reserve(size_t size)
     return memory;
 }
 
+// Writes are not logged, the buffer is not persistent.
+void storage::log_write(const uint8_t*, size_t)
+{
+}
+
+void storage::log_allocation(size_t)
+{
+}
+
 } // namespace test
@@ -41,6 +41,8 @@ public:
     bc::database::memory_ptr access();
     bc::database::memory_ptr resize(size_t size);
     bc::database::memory_ptr reserve(size_t size);
+    void log_write(const uint8_t* data, size_t size);
+    void log_allocation(size_t offset);
 
 private:
     bool closed_;
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/format.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_CHECKCHAIN_OPEN_FAIL \
+    "Failed to open database files in %1%.\n"
+#define BS_CHECKCHAIN_EMPTY \
+    "The database in %1% has no confirmed blocks.\n"
+#define BS_CHECKCHAIN_CORRUPT \
+    "Checksum mismatch in block %1% at height %2%.\n"
+#define BS_CHECKCHAIN_MISSING \
+    "Missing block or transaction at height %1%.\n"
+#define BS_CHECKCHAIN_RESULT \
+    "Checked %1% blocks (%2% without checksum), %3% failed.\n"
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::database;
+using boost::format;
+
+// Verify the transactions of each confirmed block against its checksum.
+// Heights are interleaved across threads, output order is not preserved.
+int main(int argc, char** argv)
+{
+    std::string prefix("mainnet");
+
+    if (argc > 1)
+        prefix = argv[1];
+
+    settings configuration;
+    configuration.directory = prefix;
+    data_base database(configuration);
+
+    if (!database.open())
+    {
+        std::cerr << format(BS_CHECKCHAIN_OPEN_FAIL) % prefix;
+        return -1;
+    }
+
+    size_t top;
+    const auto& blocks = database.blocks();
+    const auto& transactions = database.transactions();
+
+    if (!blocks.top(top))
+    {
+        std::cerr << format(BS_CHECKCHAIN_EMPTY) % prefix;
+        return -1;
+    }
+
+    const auto count = top + 1;
+    const auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::atomic<size_t> unchecked(0);
+    std::atomic<size_t> failed(0);
+
+    const auto scan = [&](size_t bucket)
+    {
+        for (auto height = bucket; height < count; height += threads)
+        {
+            const auto result = blocks.get(height);
+            transaction::list txs;
+            txs.reserve(result.transaction_count());
+
+            for (const auto link: result)
+            {
+                const auto tx = transactions.get(link);
+
+                if (!tx)
+                    break;
+
+                txs.push_back(tx.transaction());
+            }
+
+            if (!result || txs.size() != result.transaction_count())
+            {
+                ++failed;
+                std::cerr << (format(BS_CHECKCHAIN_MISSING) % height).str();
+                continue;
+            }
+
+            if (result.checksum() == 0)
+                ++unchecked;
+
+            if (!result.verify(txs))
+            {
+                ++failed;
+                std::cerr << (format(BS_CHECKCHAIN_CORRUPT) %
+                    encode_hash(result.hash()) % height).str();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+
+    for (size_t bucket = 0; bucket < threads; ++bucket)
+        pool.emplace_back(scan, bucket);
+
+    for (auto& thread: pool)
+        thread.join();
+
+    std::cout << format(BS_CHECKCHAIN_RESULT) % count % unchecked.load() %
+        failed.load();
+    return failed == 0 ? 0 : -1;
+}